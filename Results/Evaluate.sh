@@ -1,5 +1,27 @@
 #!/usr/bin/env bash
 
+# batchrun.sh keeps the binary sample files of its instances (samples-NN.bin), older runs have a samples.txt
+function SampleFiles {
+    # $1: Experiment directory
+    if compgen -G "$1/samples-*.bin" > /dev/null ; then
+        echo "$1"/samples-*.bin
+    else
+        echo "$1/samples.txt"
+    fi
+}
+
+# pdfcompare only reads text, so binary samples get converted on the fly
+function CompareSamples {
+    # $1: Measured delays
+    # $2: Experiment directory
+    local Files=$(SampleFiles "$2")
+    if [[ "$Files" == *.bin* ]] ; then
+        pdfcompare "$1" <(./smcd.py $Files) 2> /dev/null
+    else
+        pdfcompare "$1" $Files 2> /dev/null
+    fi
+}
+
 function GetInformation {
     # $1:
     # Sobel-TL1, JPEG-ML3, ...
@@ -14,26 +36,26 @@ function GetInformation {
     echo -e "\e[1;34mMeasured:    \e[1;32m$Measured"
     
     if [[ -d "$AVGDir" ]] ; then
-        local Average=$(./avg.py $AVGDir/samples.txt)
+        local Average=$(./avg.py $(SampleFiles $AVGDir))
         echo -e -n "\e[1;34mAVG-Model:   \e[1;36m$Average "
         echo -e -n "\e[1;31m$(octave --eval "disp((($Average -$Measured)/$Measured)*100)")% "
-        echo -e -n "\e[1;35m$(pdfcompare "$2" $AVGDir/samples.txt 2> /dev/null)"
+        echo -e -n "\e[1;35m$(CompareSamples "$2" $AVGDir)"
         echo
     fi
     
     if [[ -d "$GaussDir" ]] ; then
-        local Gaussian=$(./avg.py $GaussDir/samples.txt)
+        local Gaussian=$(./avg.py $(SampleFiles $GaussDir))
         echo -e -n "\e[1;34mGauss-Model: \e[1;36m$Gaussian "
         echo -e -n "\e[1;31m$(octave --eval "disp((($Gaussian-$Measured)/$Measured)*100)")% "
-        echo -e -n "\e[1;35m$(pdfcompare "$2" $GaussDir/samples.txt 2> /dev/null)"
+        echo -e -n "\e[1;35m$(CompareSamples "$2" $GaussDir)"
         echo
     fi
 
     if [[ -d "$KDEDir" ]] ; then
-        local KDE=$(./avg.py $KDEDir/samples.txt)
+        local KDE=$(./avg.py $(SampleFiles $KDEDir))
         echo -e -n "\e[1;34mKDE-Model:   \e[1;36m$KDE "
         echo -e -n "\e[1;31m$(octave --eval "disp((($KDE     -$Measured)/$Measured)*100)")% "
-        echo -e -n "\e[1;35m$(pdfcompare "$2" $KDEDir/samples.txt 2> /dev/null) "
+        echo -e -n "\e[1;35m$(CompareSamples "$2" $KDEDir) "
         echo -e -n "\e[1;30m$(grep real $KDEDir/exectime.txt)"
         echo
     fi
@@ -1,17 +1,30 @@
 #!/usr/bin/env python3
 import argparse
+import smcd
 
 cli = argparse.ArgumentParser(description="Calculate average value from list of integers inside a file")
-cli.add_argument("infile", type=str, action="store",
-    help="Path where the measured data will be read from.")
+cli.add_argument("infiles", type=str, nargs="+", action="store",
+    help="Paths where the measured data will be read from. Text (one integer per line) or binary sample files of the model. Several files get averaged together.")
 args = cli.parse_args()
 
+def ReadValues(path):
+    if smcd.IsSampleFile(path):
+        yield from smcd.ReadSamples(path)
+    else:
+        with open(path) as f:
+            for line in f:
+                yield int(line)
+
 if __name__ == '__main__':
+    total = 0
+    count = 0
     try:
-        with open(args.infile) as f:
-            lines = f.read().splitlines()
-    except FileNotFoundError:
+        for path in args.infiles:
+            for value in ReadValues(path):
+                total += value
+                count += 1
+    except (FileNotFoundError, ValueError):
         exit(1)
-    data   = [int(line) for line in lines]
-    print("%5f"%(sum(data)/float(len(data))))
-
+    if count == 0:
+        exit(1)
+    print("%5f"%(total/float(count)))
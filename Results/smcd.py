@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+#
+# Reader for the binary sample files of the model (--sink binary, see samplesink.hpp).
+#
+# As a script, it converts sample files into the text format, one iteration duration per line:
+#   ./smcd.py samples-00.bin samples-01.bin > samples.txt
+# With --info, it prints the header of each file instead.
+# With --count, it prints the total number of samples of all files, taken from their headers.
+#
+# As a module:
+#   import smcd
+#   header  = smcd.ReadHeader(path)
+#   samples = list(smcd.ReadSamples(path))
+
+import argparse
+import struct
+import sys
+
+MAGIC    = b"SMCD"
+VERSION  = 1
+ENCODING = 1
+UNKNOWN  = 2**64 - 1   # Number of samples of a file that was not closed properly
+
+
+
+def IsSampleFile(path):
+    with open(path, "rb") as f:
+        return f.read(len(MAGIC)) == MAGIC
+
+
+
+def _ReadHeader(f, path):
+    fixed = f.read(36)
+    if len(fixed) != 36 or fixed[0:4] != MAGIC:
+        raise ValueError("%s is not a sample file"%(path))
+
+    version, encoding, seed, skip, count, namelength = struct.unpack("<HHQQQI", fixed[4:36])
+    if version != VERSION or encoding != ENCODING:
+        raise ValueError("%s: Unsupported version %d (encoding %d)"%(path, version, encoding))
+
+    name = f.read(namelength)
+    if len(name) != namelength:
+        raise ValueError("%s: Header ends in the middle of the experiment name"%(path))
+
+    return {"seed": seed, "skip": skip, "count": None if count == UNKNOWN else count,
+            "experiment": name.decode("utf-8", "replace")}
+
+
+
+def ReadHeader(path):
+    with open(path, "rb") as f:
+        return _ReadHeader(f, path)
+
+
+
+# Only files that were not closed properly need to be decoded
+def CountSamples(path):
+    count = ReadHeader(path)["count"]
+    if count is None:
+        count = sum(1 for sample in ReadSamples(path))
+    return count
+
+
+
+# Each sample is the zigzag encoded difference to the previous one as LEB128 varint
+def ReadSamples(path):
+    with open(path, "rb") as f:
+        _ReadHeader(f, path)
+        data = f.read()
+
+    previous = 0
+    zigzag   = 0
+    shift    = 0
+    for byte in data:
+        zigzag |= (byte & 0x7F) << shift
+        shift  += 7
+        if byte & 0x80:
+            continue
+
+        delta    = (zigzag >> 1) ^ -(zigzag & 1)
+        previous = (previous + delta) & UNKNOWN
+        zigzag   = 0
+        shift    = 0
+        yield previous
+
+    if shift > 0:
+        raise ValueError("%s ends in the middle of a sample"%(path))
+
+
+
+if __name__ == '__main__':
+    cli = argparse.ArgumentParser(description="Convert binary sample files of the model into text, one sample per line")
+    cli.add_argument("infiles", type=str, nargs="+", action="store",
+        help="Sample files written with --sink binary. The samples get written in the given order.")
+    cli.add_argument("--info", action="store_true",
+        help="Print the header of each file instead of the samples.")
+    cli.add_argument("--count", action="store_true",
+        help="Print the total number of samples of all files instead of the samples.")
+    args = cli.parse_args()
+
+    try:
+        if args.count:
+            print(sum(CountSamples(path) for path in args.infiles))
+            exit(0)
+
+        for path in args.infiles:
+            if args.info:
+                header = ReadHeader(path)
+                print("%s: experiment %s, seed %d, skip %d, samples %s"%(path, header["experiment"],
+                    header["seed"], header["skip"], "unknown" if header["count"] is None else header["count"]))
+                continue
+
+            sys.stdout.writelines("%d\n"%(sample) for sample in ReadSamples(path))
+    except BrokenPipeError:
+        pass
+    except (OSError, ValueError) as e:
+        print("ERROR: %s"%(e), file=sys.stderr)
+        exit(1)
+
+# vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
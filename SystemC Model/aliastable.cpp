@@ -0,0 +1,79 @@
+#include <aliastable.hpp>
+#include <numeric>
+#include <stdexcept>
+
+AliasTable::AliasTable()
+{
+}
+
+
+
+void AliasTable::Build(const std::vector<double> &values, const std::vector<double> &weights)
+{
+    if(values.empty() or values.size() != weights.size())
+        throw std::invalid_argument("AliasTable: Number of values and weights must be equal and not 0");
+
+    size_t n     = values.size();
+    double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    this->values = values;
+    this->probabilities.resize(n);
+    this->aliases.resize(n);
+
+    // Scale the probabilities so that the average column is exactly full (1.0)
+    std::vector<double>   scaled(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for(uint32_t i = 0; i < n; i++)
+    {
+        scaled[i] = weights[i] * n / total;
+        if(scaled[i] < 1.0)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    // Fill each underfull column with the excess of an overfull column
+    while(not small.empty() and not large.empty())
+    {
+        uint32_t less = small.back(); small.pop_back();
+        uint32_t more = large.back(); large.pop_back();
+
+        this->probabilities[less] = scaled[less];
+        this->aliases[less]       = more;
+
+        scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+        if(scaled[more] < 1.0)
+            small.push_back(more);
+        else
+            large.push_back(more);
+    }
+
+    // The remaining columns are full. Numerical errors can leave some in the small list.
+    for(uint32_t i : large)
+    {
+        this->probabilities[i] = 1.0;
+        this->aliases[i]       = i;
+    }
+    for(uint32_t i : small)
+    {
+        this->probabilities[i] = 1.0;
+        this->aliases[i]       = i;
+    }
+}
+
+
+
+size_t AliasTable::Size() const
+{
+    return this->values.size();
+}
+
+
+
+size_t AliasTable::MemoryUsage() const
+{
+    return this->values.size() * (sizeof(double) + sizeof(double) + sizeof(uint32_t));
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
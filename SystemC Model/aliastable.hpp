@@ -0,0 +1,49 @@
+#ifndef ALIASTABLE_HPP
+#define ALIASTABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Walker's alias method (with Vose's construction) for sampling a discrete distribution in constant time.
+//
+// The table has one column per value. Each column holds the probability to take its own value
+// and the index of an alias value that gets taken otherwise.
+// One uniform random number selects the column and decides between the value and its alias.
+
+class AliasTable
+{
+    public:
+        AliasTable();
+
+        // The weights do not need to be normalized. Values with weight 0 are never sampled.
+        void Build(const std::vector<double> &values, const std::vector<double> &weights);
+
+        // Maps a uniform random number u in [0, 1) to a value
+        inline double Sample(double u) const;
+
+        size_t Size() const;
+        size_t MemoryUsage() const; // in bytes
+
+    private:
+        std::vector<double>   values;
+        std::vector<double>   probabilities;
+        std::vector<uint32_t> aliases;
+};
+
+
+
+double AliasTable::Sample(double u) const
+{
+    // The integer part selects the column, the fractional part is uniform in [0, 1) again
+    double   position = u * this->values.size();
+    uint32_t column   = static_cast<uint32_t>(position);
+    double   fraction = position - column;
+
+    if(fraction < this->probabilities[column])
+        return this->values[column];
+    return this->values[this->aliases[column]];
+}
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
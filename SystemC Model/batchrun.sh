@@ -10,6 +10,7 @@ VCPUs=$(nproc)
 Host="$(hostname)"
 Instances=$(( VCPUs / 2))
 SamplesPerInstance=$(( TotalSamples / Instances ))
+SampleReader="../Results/smcd.py"  # Reads the headers of the binary sample files
 Experiments=(
 mdpi-Sobel2-CA1Average
 mdpi-Sobel2-CA1Gaussian
@@ -92,9 +93,9 @@ function ExecuteSimulation
 
     for i in $(seq 0 $(( Instances - 1 ))) ; do
         local Offset=$(( SamplesPerInstance * i ))
-        local ResultsPath=$ExperimentDirectory/samples-$(printf "%02d" $i).txt
+        local ResultsPath=$ExperimentDirectory/samples-$(printf "%02d" $i).bin
 
-        ./model --experiment $Experiment --iterations $SamplesPerInstance --skip $Offset 2> /dev/null > "$ResultsPath" &
+        ./model --experiment $Experiment --iterations $SamplesPerInstance --skip $Offset --sink binary --output "$ResultsPath" 2> /dev/null &
     done
 
     # Wait until all processes finish
@@ -122,28 +123,31 @@ function RunExperiment
 
     LANG=en_US date > "$ExperimentDirectory/end.txt"
 
-    # Merge samples of each instance
-    local AllSamplesFile="$ExperimentDirectory/samples.txt"
-
-    if [ -f "$AllSamplesFile" ] ; then
-        # In case there is an old samples.txt, remove it to not append new data to old data
-        rm $AllSamplesFile
+    # The samples of each instance stay in its binary file (samples-NN.bin, in the order of the instances).
+    # Results/avg.py and Results/Evaluate.sh read them directly.
+    if [ -f "$ExperimentDirectory/samples.txt" ] ; then
+        # A samples.txt of an older run would not match the new samples
+        rm "$ExperimentDirectory/samples.txt"
     fi
 
+    local SamplesPaths=()
     for i in $(seq 0 $(( Instances - 1 ))) ; do
-        local SamplesPath=$ExperimentDirectory/samples-$(printf "%02d" $i).txt
+        local SamplesPath=$ExperimentDirectory/samples-$(printf "%02d" $i).bin
 
         if [ ! -f $SamplesPath ] ; then
             echo "ERROR: Samples for run $i ($SamplesPath) does not exist!" | tee -a $InfoFile
             continue
         fi
-
-        cat $SamplesPath >> $AllSamplesFile
-        rm  $SamplesPath
+        SamplesPaths+=("$SamplesPath")
     done
 
-    # Check if run was successful
-    local NumSamples=$(wc -l $AllSamplesFile | cut -d ' ' -f 1)
+    # Check if run was successful. The number of samples is stored in the header of each file.
+    local NumSamples=0
+    if [ ${#SamplesPaths[@]} -gt 0 ] ; then
+        if ! NumSamples=$($SampleReader --count "${SamplesPaths[@]}") ; then
+            echo "ERROR: Reading the sample files failed!" | tee -a $InfoFile
+        fi
+    fi
     if [ "$TotalSamples" != "$NumSamples" ] ; then
         echo "ERROR: Total Samples ($TotalSamples) ≠ Simulated Samples ($NumSamples)!" | tee -a $InfoFile
     fi
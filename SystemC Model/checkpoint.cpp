@@ -0,0 +1,299 @@
+#include <checkpoint.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <hardware/tile.hpp>
+#include <hardware/memory.hpp>
+#include <hardware/interconnect.hpp>
+#include <software/channel.hpp>
+#include <software/actor.hpp>
+#include <setup/sdfapplication.hpp>
+#include <delayvectorregistry.hpp>
+#include <monitor.hpp>
+#include <statestream.hpp>
+
+// File format (host byte order, see statestream.hpp):
+//   magic "SMCK", version, configuration, interval, iteration, simulated time,
+//   followed by the state of the monitor, the delay vectors, the application, the interconnect,
+//   the memories, the channels and the actors.
+
+const char Checkpoint::MAGIC[4] = {'S', 'M', 'C', 'K'};
+
+Checkpoint::Checkpoint(const std::string &path, uint64_t interval, const std::string &configuration,
+                       Monitor &monitor, DelayVectorRegistry &delayvectors, SDFApplication &application, Interconnect &interconnect)
+    : path(path)
+    , interval(interval)
+    , configuration(configuration)
+    , monitor(&monitor)
+    , delayvectors(&delayvectors)
+    , application(&application)
+    , interconnect(&interconnect)
+    , arrived(0)
+    , iteration(0)
+    , time(0)
+{
+}
+
+
+
+Checkpoint& Checkpoint::operator<< (Tile &tile)
+{
+    *this << static_cast<Memory&>(tile);
+
+    // Tiles without actors do not simulate anything
+    if(not tile.HasActors())
+        return *this;
+
+    this->tiles.push_back(&tile);
+    this->releaseevents.emplace_back(new sc_core::sc_event());
+    tile.SetCheckpoint(this);
+    return *this;
+}
+
+Checkpoint& Checkpoint::operator<< (Memory &memory)
+{
+    this->memories.push_back(&memory);
+    return *this;
+}
+
+Checkpoint& Checkpoint::operator<< (Channel &channel)
+{
+    this->channels.push_back(&channel);
+    return *this;
+}
+
+Checkpoint& Checkpoint::operator<< (Actor &actor)
+{
+    this->actors.push_back(&actor);
+    return *this;
+}
+
+
+
+uint64_t Checkpoint::GetIteration() const
+{
+    return this->iteration;
+}
+
+uint64_t Checkpoint::GetInterval() const
+{
+    return this->interval;
+}
+
+const std::string& Checkpoint::GetPath() const
+{
+    return this->path;
+}
+
+bool Checkpoint::IsDue(uint64_t iteration) const
+{
+    return this->interval > 0 and iteration % this->interval == 0;
+}
+
+
+
+void Checkpoint::Load()
+{
+    std::ifstream file(this->path, std::ios::binary);
+    if(not file.is_open())
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Opening checkpoint " << this->path << " failed!\n";
+        throw std::runtime_error("Opening checkpoint failed!");
+    }
+
+    char magic[sizeof(MAGIC)];
+    if(not file.read(magic, sizeof(magic)) or not std::equal(magic, magic + sizeof(magic), MAGIC)
+    or state::Read<uint16_t>(file) != VERSION)
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m " << this->path << " is not a checkpoint of this simulator version!\n";
+        throw std::runtime_error("Invalid checkpoint!");
+    }
+
+    std::string configuration = state::ReadString(file);
+    if(configuration != this->configuration)
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Checkpoint " << this->path << " belongs to a different simulation!\n"
+                  << "\e[1;30m    Checkpoint: " << configuration       << "\n"
+                  << "    Now:        "       << this->configuration << "\e[0m\n";
+        throw std::runtime_error("Checkpoint does not match the simulation!");
+    }
+
+    uint64_t interval = state::Read<uint64_t>(file);
+    if(this->interval == 0)
+        this->interval = interval;
+    else if(this->interval != interval)
+    {
+        // The checkpoints drain the pipeline, so the interval influences the results
+        std::cerr << "\e[1;31mERROR:\e[0m Checkpoint " << this->path << " was written with an interval of "
+                  << interval << " iterations, not " << this->interval << "!\n";
+        throw std::runtime_error("Checkpoint does not match the simulation!");
+    }
+
+    this->iteration = state::Read<uint64_t>(file);
+    this->time      = state::Read<sc_dt::uint64>(file);
+    this->state.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    std::cerr << "\e[1;34mResuming after iteration " << this->iteration << " at "
+              << sc_core::sc_time::from_value(this->time) << "\e[0m\n";
+}
+
+
+
+// The simulation may end in the same delta cycle. Then there is nothing to resume.
+void Checkpoint::Barrier(Tile *tile, uint64_t iteration)
+{
+    this->arrived++;
+    if(this->arrived == this->tiles.size())
+    {
+        this->arrived = 0;
+        if(not this->monitor->HasStopped())
+            this->Save(iteration);
+        this->Release();
+    }
+    this->Wait(tile);
+}
+
+
+
+uint64_t Checkpoint::Resume(Tile *tile)
+{
+    if(this->iteration == 0)
+        return 0;
+
+    this->arrived++;
+    if(this->arrived == this->tiles.size())
+    {
+        this->arrived = 0;
+
+        sc_core::sc_time time = sc_core::sc_time::from_value(this->time);
+        if(time < sc_core::sc_time_stamp())
+            throw std::runtime_error("Checkpoint lies before the end of the initialization");
+        sc_core::wait(time - sc_core::sc_time_stamp());
+
+        this->Restore();
+        this->Release();
+    }
+    this->Wait(tile);
+    return this->iteration;
+}
+
+
+
+// All tiles continue in the same delta cycle, in the order they were added
+void Checkpoint::Release()
+{
+    for(auto &event : this->releaseevents)
+        event->notify(sc_core::SC_ZERO_TIME);
+}
+
+void Checkpoint::Wait(Tile *tile)
+{
+    size_t index = std::find(this->tiles.begin(), this->tiles.end(), tile) - this->tiles.begin();
+    sc_core::wait(*this->releaseevents.at(index));
+}
+
+
+
+// The state gets collected first, so writing the file cannot be interrupted by the simulation.
+// Saving the state of the sample sink writes its samples to the disk,
+// so they are there before the checkpoint refers to them.
+void Checkpoint::Save(uint64_t iteration)
+{
+    std::ostringstream contents;
+    contents.write(MAGIC, sizeof(MAGIC));
+    state::Write<uint16_t>(contents, VERSION);
+    state::WriteString(contents, this->configuration);
+    state::Write<uint64_t>(contents, this->interval);
+    state::Write<uint64_t>(contents, iteration);
+    state::Write<sc_dt::uint64>(contents, sc_core::sc_time_stamp().value());
+
+    // A failed checkpoint does not end the simulation, the previous checkpoint stays valid
+    try
+    {
+        this->monitor->SaveState(contents);
+    }
+    catch(std::runtime_error &e)
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Writing checkpoint " << this->path << " failed - " << e.what()
+                  << " \e[1;30m(Keeping the previous checkpoint)\e[0m\n";
+        return;
+    }
+    this->delayvectors->SaveState(contents);
+    this->application->SaveState(contents);
+    this->interconnect->SaveState(contents);
+    for(Memory *memory : this->memories)
+        memory->SaveState(contents);
+    for(Channel *channel : this->channels)
+        channel->SaveState(contents);
+    for(Actor *actor : this->actors)
+        actor->SaveState(contents);
+
+    std::string temporary = this->path + ".tmp";
+    std::string data      = contents.str();
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool success = fd >= 0;
+    for(size_t written = 0; success and written < data.size(); )
+    {
+        ssize_t count = write(fd, data.data() + written, data.size() - written);
+        if(count < 0 and errno == EINTR)
+            continue;
+        success  = count > 0;
+        written += success ? count : 0;
+    }
+    success = success and fsync(fd) == 0;
+    if(fd >= 0)
+        success = close(fd) == 0 and success;
+    success = success and rename(temporary.c_str(), this->path.c_str()) == 0;
+
+    if(not success)
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Writing checkpoint " << this->path << " failed - " << strerror(errno)
+                  << " \e[1;30m(Keeping the previous checkpoint)\e[0m\n";
+        unlink(temporary.c_str());
+        return;
+    }
+    std::cerr << "\e[1;30mCheckpoint after iteration " << iteration << " written to " << this->path << "\e[0m\n";
+}
+
+
+
+void Checkpoint::Restore()
+{
+    std::istringstream contents(this->state);
+
+    this->monitor->LoadState(contents);
+    this->delayvectors->LoadState(contents);
+    this->application->LoadState(contents);
+    this->interconnect->LoadState(contents);
+    for(Memory *memory : this->memories)
+        memory->LoadState(contents);
+    for(Channel *channel : this->channels)
+        channel->LoadState(contents);
+    for(Actor *actor : this->actors)
+        actor->LoadState(contents);
+
+    if(contents.peek() != std::char_traits<char>::eof())
+        throw std::runtime_error("Checkpoint contains more state than the simulation");
+
+    // Not needed anymore
+    this->state.clear();
+    this->state.shrink_to_fit();
+}
+
+
+
+void Checkpoint::Remove()
+{
+    if(unlink(this->path.c_str()) != 0 and errno != ENOENT)
+        std::cerr << "\e[1;33mWARNING:\e[0m Removing checkpoint " << this->path << " failed - " << strerror(errno) << "\n";
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,101 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <systemc>
+
+class Tile;
+class Memory;
+class Channel;
+class Actor;
+class Interconnect;
+class Monitor;
+class DelayVectorRegistry;
+class SDFApplication;
+
+// Periodic checkpoints of a simulation, and resuming from the last one.
+//
+// The stacks of the SystemC processes can not be stored, so checkpoints get taken where their state is known:
+// Every interval iterations, each tile waits after its iteration until all tiles finished the same iteration.
+// Then no tokens are in flight, the bus is idle and all tiles are at the beginning of their loop.
+// What remains is the state of the components: Memory contents, usage flags of the channels, bus arbitration,
+// actor state, static variables of the kernels, positions of the delay vectors, the monitor with its
+// sample sink, and the simulated time.
+//
+// Waiting for all tiles drains the pipeline, so the iterations after a checkpoint start like after a restart.
+// This changes the timing of the tiles, so only the functional model supports checkpoints.
+// Its output does not depend on the timing, so a resumed simulation produces the same output as an uninterrupted one.
+//
+// When resuming, the tiles initialize their actors as usual and then wait for each other like at a checkpoint.
+// The last one advances the simulated time to the time of the checkpoint, loads the state and releases all tiles.
+// The tiles get released in the order they were added, at checkpoints and when resuming.
+//
+// The file gets replaced atomically, so a crash while writing keeps the previous checkpoint.
+
+class Checkpoint
+{
+    public:
+        // configuration: Describes everything that influences the simulation (experiment, models, seed, ...).
+        // A checkpoint can only be resumed with the same configuration.
+        Checkpoint(const std::string &path, uint64_t interval, const std::string &configuration,
+                   Monitor &monitor, DelayVectorRegistry &delayvectors, SDFApplication &application, Interconnect &interconnect);
+
+        // Tiles with actors wait for each other at each checkpoint. The private memory of all tiles belongs to the state.
+        Checkpoint& operator<< (Tile &tile);
+        Checkpoint& operator<< (Memory &memory);
+        Checkpoint& operator<< (Channel &channel);
+        Checkpoint& operator<< (Actor &actor);
+
+        // Reads the checkpoint file before the simulation starts. The tiles load the state when they call Resume.
+        // Without an interval, the interval of the checkpoint gets used.
+        // Throws std::runtime_error if the file is missing or was written with a different configuration.
+        void Load();
+        uint64_t GetIteration() const;  // of the loaded checkpoint, 0 if none got loaded
+        uint64_t GetInterval()  const;
+        const std::string& GetPath() const;
+
+        bool IsDue(uint64_t iteration) const;   // true if a checkpoint gets taken after this iteration
+
+        // Called by each tile after the iteration a checkpoint is due for
+        void Barrier(Tile *tile, uint64_t iteration);
+        // Called by each tile after initializing its actors. Returns the number of iterations that are done already.
+        uint64_t Resume(Tile *tile);
+
+        void Remove();  // Deletes the checkpoint file after the simulation completed
+
+        static const char     MAGIC[4];
+        static const uint16_t VERSION = 1;
+
+    private:
+        void Save(uint64_t iteration);
+        void Restore();
+        void Release();
+        void Wait(Tile *tile);
+
+        std::string path;
+        uint64_t    interval;
+        std::string configuration;
+
+        Monitor             *monitor;
+        DelayVectorRegistry *delayvectors;
+        SDFApplication      *application;
+        Interconnect        *interconnect;
+        std::vector<Tile*>    tiles;    // Taking part in the checkpoints
+        std::vector<Memory*>  memories;
+        std::vector<Channel*> channels;
+        std::vector<Actor*>   actors;
+
+        std::vector<std::unique_ptr<sc_core::sc_event>> releaseevents;  // Indexed like tiles
+        size_t arrived;     // Number of tiles waiting for the others
+
+        // The loaded checkpoint
+        uint64_t      iteration;
+        sc_dt::uint64 time;
+        std::string   state;
+};
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
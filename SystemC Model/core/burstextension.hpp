@@ -0,0 +1,52 @@
+#ifndef BURSTEXTENSION_HPP
+#define BURSTEXTENSION_HPP
+
+#include <systemc>
+#include <tlm.h>
+
+namespace core
+{
+
+// A burst transfers several consecutive words with one transaction.
+// The beat gap is the time the initiator needs between two beats
+// (for example to increment its pointers). The bus is not occupied during this time.
+// Without this extension, the beats of a burst follow each other without gap.
+//
+// An interconnect that passes the whole burst to the target as one transaction
+// can set an observer. The target then calls EndOfBeat after each beat instead of waiting the beat gap itself,
+// so that the interconnect can account each beat like a single word transaction.
+// For the last beat, the gap is zero.
+
+class BeatObserver
+{
+    public:
+        virtual ~BeatObserver() {};
+        virtual void EndOfBeat(tlm::tlm_command command, const sc_core::sc_time &gap) = 0;
+};
+
+class BurstExtension
+    : public tlm::tlm_extension<BurstExtension>
+{
+    public:
+        BurstExtension(sc_core::sc_time beatgap = sc_core::SC_ZERO_TIME, BeatObserver *observer = nullptr)
+            : beatgap(beatgap)
+            , observer(observer) {};
+
+        virtual tlm::tlm_extension_base* clone() const
+        {
+            return new BurstExtension(this->beatgap, this->observer);
+        }
+        virtual void copy_from(tlm::tlm_extension_base const &extension)
+        {
+            this->beatgap  = static_cast<BurstExtension const &>(extension).beatgap;
+            this->observer = static_cast<BurstExtension const &>(extension).observer;
+        }
+
+        sc_core::sc_time beatgap;
+        BeatObserver    *observer;  // Not owned, only set while the interconnect forwards the burst
+};
+
+} // namespace core
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -1,4 +1,5 @@
 #include <core/bus.hpp>
+#include <core/burstextension.hpp>
 #include <iostream>
 
 namespace core
@@ -9,7 +10,9 @@ Bus::Bus(sc_core::sc_module_name name)
     , target_socket("target_bus_socket")
     , initiator_socket("initiator_bus_socket")
 {
-    this->target_socket.register_b_transport(this, &Bus::b_transport);
+    this->target_socket.register_b_transport(this, &Bus::Transport);
+    this->target_socket.register_get_direct_mem_ptr(this, &Bus::get_direct_mem_ptr);
+    this->initiator_socket.register_invalidate_direct_mem_ptr(this, &Bus::invalidate_direct_mem_ptr);
 }
 
 
@@ -22,6 +25,56 @@ void Bus::end_of_elaboration()
 
 
 
+void Bus::Transport(int id, tlm::tlm_generic_payload& trans, sc_core::sc_time& delay)
+{
+    const unsigned int BYTES_PER_WORD = 4;
+    unsigned int  data_length = trans.get_data_length();
+
+    BurstExtension *burst;
+    trans.get_extension(burst);
+
+    sc_core::sc_time beatgap = sc_core::SC_ZERO_TIME;
+    if(burst != nullptr)
+        beatgap = burst->beatgap;
+
+    if(data_length <= BYTES_PER_WORD or not this->SplitsBurst(beatgap))
+    {
+        this->b_transport(id, trans, delay);
+        return;
+    }
+
+    // Process the burst beat by beat.
+    // The payload gets reused for each beat and restored afterwards.
+    sc_dt::uint64  address = trans.get_address();
+    unsigned char* data    = trans.get_data_ptr();
+    unsigned int   beats   = data_length / BYTES_PER_WORD;
+
+    trans.set_data_length(BYTES_PER_WORD);
+    trans.set_streaming_width(BYTES_PER_WORD);
+
+    for(unsigned int beat = 0; beat < beats; beat++)
+    {
+        trans.set_address(address + beat);
+        trans.set_data_ptr(data + beat * BYTES_PER_WORD);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+        this->b_transport(id, trans, delay);
+
+        if(trans.get_response_status() != tlm::TLM_OK_RESPONSE)
+            break;
+
+        if(beat + 1 < beats and beatgap != sc_core::SC_ZERO_TIME)
+            sc_core::wait(beatgap);
+    }
+
+    trans.set_address(address);
+    trans.set_data_ptr(data);
+    trans.set_data_length(data_length);
+    trans.set_streaming_width(data_length);
+}
+
+
+
 void Bus::b_transport(int id, tlm::tlm_generic_payload& trans, sc_core::sc_time& delay)
 {
     // Try to arbitrate the bus.
@@ -48,6 +101,28 @@ void Bus::b_transport(int id, tlm::tlm_generic_payload& trans, sc_core::sc_time&
 }
 
 
+bool Bus::get_direct_mem_ptr(int id, tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi)
+{
+    // The bus does not translate addresses.
+    // So the DMI region of the slave can be passed to the master as it is.
+    int slaveid = this->AddressToSlaveID(trans.get_address());
+    if(slaveid < 0)
+        return false;
+
+    return this->initiator_socket[slaveid]->get_direct_mem_ptr(trans, dmi);
+}
+
+
+
+void Bus::invalidate_direct_mem_ptr(int id, sc_dt::uint64 start, sc_dt::uint64 end)
+{
+    // Any master may hold a pointer into the invalidated region
+    for(unsigned int i = 0; i < this->target_socket.size(); i++)
+        this->target_socket[i]->invalidate_direct_mem_ptr(start, end);
+}
+
+
+
 int Bus::AddressToSlaveID(unsigned int addr)
 {
     for(unsigned int i = 0; i < this->starts.size(); i++)
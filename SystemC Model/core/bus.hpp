@@ -30,8 +30,17 @@ class Bus
         // Address mapping
         int AddressToSlaveID(unsigned int addr);
 
+        // When true, bursts get split into single word transactions
+        // so that b_transport handles one beat at a time.
+        // This is only necessary if other initiators can get the bus between two beats.
+        // The bus is released during the beat gap, so by default bursts with a beat gap get split.
+        virtual bool SplitsBurst(const sc_core::sc_time &beatgap) const { return beatgap != sc_core::SC_ZERO_TIME; };
+
     private:
+        void Transport(int id, tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
         virtual void b_transport(int id, tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
+        bool get_direct_mem_ptr(int id, tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi);
+        void invalidate_direct_mem_ptr(int id, sc_dt::uint64 start, sc_dt::uint64 end);
         virtual void end_of_elaboration();
 
         std::mutex mutex;
@@ -1,4 +1,5 @@
 #include <core/master.hpp>
+#include <core/burstextension.hpp>
 #include <iostream>
 
 namespace core
@@ -8,6 +9,9 @@ namespace core
 Master::Master(sc_core::sc_module_name name)
     : sc_core::sc_module(name)
     , initiator_socket("socket")
+    , dmienabled(false)
+    , dmivalid(false)
+    , dmidenied(false)
 {
     std::cerr << "\e[1;30mMaster constructor called for \033[0m" << this->name() << std::endl;
     this->initiator_socket.bind(*this);
@@ -16,8 +20,20 @@ Master::Master(sc_core::sc_module_name name)
 
 const int BYTES_PER_WORD = 4;
 
+void Master::EnableDMI(bool enable)
+{
+    this->dmienabled = enable;
+    this->dmivalid   = false;
+    this->dmidenied  = false;
+}
+
+
+
 void Master::WriteWord(sc_dt::uint64 addr, unsigned int* word)
 {
+    if(this->DirectAccess(tlm::TLM_WRITE_COMMAND, addr, word, 1, sc_core::SC_ZERO_TIME))
+        return;
+
     tlm::tlm_generic_payload pl;
     pl.set_byte_enable_ptr(NULL);
     pl.set_byte_enable_length(0);
@@ -47,6 +63,9 @@ void Master::WriteWord(sc_dt::uint64 addr, unsigned int* word)
 
 void Master::ReadWord(sc_dt::uint64 addr, unsigned int* word)
 {
+    if(this->DirectAccess(tlm::TLM_READ_COMMAND, addr, word, 1, sc_core::SC_ZERO_TIME))
+        return;
+
     tlm::tlm_generic_payload pl;
     pl.set_byte_enable_ptr(NULL);
     pl.set_byte_enable_length(0);
@@ -74,15 +93,137 @@ void Master::ReadWord(sc_dt::uint64 addr, unsigned int* word)
 
 
 
+void Master::WriteBurst(sc_dt::uint64 addr, unsigned int* words, unsigned int count, sc_core::sc_time beatgap)
+{
+    this->Burst(tlm::TLM_WRITE_COMMAND, addr, words, count, beatgap);
+}
+
+
+
+void Master::ReadBurst(sc_dt::uint64 addr, unsigned int* words, unsigned int count, sc_core::sc_time beatgap)
+{
+    this->Burst(tlm::TLM_READ_COMMAND, addr, words, count, beatgap);
+}
+
+
+
+void Master::Burst(tlm::tlm_command command, sc_dt::uint64 addr, unsigned int* words, unsigned int count, sc_core::sc_time beatgap)
+{
+    if(this->DirectAccess(command, addr, words, count, beatgap))
+        return;
+
+    tlm::tlm_generic_payload pl;
+    pl.set_byte_enable_ptr(NULL);
+    pl.set_byte_enable_length(0);
+    pl.set_dmi_allowed(false);
+
+    pl.set_data_length(BYTES_PER_WORD * count);
+    pl.set_streaming_width(BYTES_PER_WORD * count);
+    pl.set_data_ptr(reinterpret_cast< unsigned char* >(words));
+
+    pl.set_address(addr);
+    pl.set_command(command);
+    pl.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+    BurstExtension burst(beatgap);
+    pl.set_extension(&burst);
+
+    sc_core::sc_time nodelay = sc_core::SC_ZERO_TIME;
+    initiator_socket->b_transport(pl, nodelay);
+
+    // The extension lives on the stack and must not be freed by the payload
+    pl.clear_extension(&burst);
+
+    if(pl.get_response_status() != tlm::TLM_OK_RESPONSE)
+    {
+        std::cerr << "\e[1;37m" << this->name() << " \033[1;36m"
+            << (command == tlm::TLM_READ_COMMAND ? "read" : "write")
+            << " burst\033[1;31m failed"
+            << "\033[1;37m at " << sc_core::sc_time_stamp()
+            << std::endl;
+    }
+}
+
+
+
+// Access count words via the cached DMI pointer.
+// If there is no valid DMI region covering the words, a new one gets requested.
+// Returns false when the access has to go through the interconnect.
+bool Master::DirectAccess(tlm::tlm_command command, sc_dt::uint64 addr, unsigned int* words, unsigned int count, sc_core::sc_time beatgap)
+{
+    if(not this->dmienabled or this->dmidenied)
+        return false;
+
+    sc_dt::uint64 last = addr + count - 1;
+    if(not this->dmivalid
+    or addr < this->dmi.get_start_address()
+    or last > this->dmi.get_end_address())
+    {
+        tlm::tlm_generic_payload pl;
+        pl.set_address(addr);
+        pl.set_command(command);
+
+        this->dmi.init();
+        this->dmivalid  = this->initiator_socket->get_direct_mem_ptr(pl, this->dmi);
+        this->dmidenied = not this->dmivalid;
+        if(not this->dmivalid)
+            return false;
+
+        if(addr < this->dmi.get_start_address() or last > this->dmi.get_end_address())
+            return false;
+    }
+
+    // Targets store one unsigned long per word address
+    unsigned long *memory = reinterpret_cast<unsigned long*>(this->dmi.get_dmi_ptr());
+    memory += addr - this->dmi.get_start_address();
+
+    if(command == tlm::TLM_READ_COMMAND)
+    {
+        if(not this->dmi.is_read_allowed())
+            return false;
+
+        for(unsigned int i = 0; i < count; i++)
+        {
+            if(i > 0 and beatgap != sc_core::SC_ZERO_TIME)
+                sc_core::wait(beatgap);
+            if(this->dmi.get_read_latency() != sc_core::SC_ZERO_TIME)
+                sc_core::wait(this->dmi.get_read_latency());
+            words[i] = memory[i];
+        }
+    }
+    else
+    {
+        if(not this->dmi.is_write_allowed())
+            return false;
+
+        for(unsigned int i = 0; i < count; i++)
+        {
+            if(i > 0 and beatgap != sc_core::SC_ZERO_TIME)
+                sc_core::wait(beatgap);
+            if(this->dmi.get_write_latency() != sc_core::SC_ZERO_TIME)
+                sc_core::wait(this->dmi.get_write_latency());
+            memory[i] = words[i];
+        }
+    }
+
+    return true;
+}
+
+
+
 tlm::tlm_sync_enum Master::nb_transport_bw(tlm::tlm_generic_payload&, tlm::tlm_phase&, sc_core::sc_time& )
 {
     std::cerr << "\e[0;33minvalidate_direct_mem_ptr called" << std::endl;
     return tlm::TLM_COMPLETED; 
 }
 
-void Master::invalidate_direct_mem_ptr(sc_dt::uint64, sc_dt::uint64 )
+void Master::invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end)
 {
-    std::cerr << "\e[0;33minvalidate_direct_mem_ptr called" << std::endl;
+    this->dmidenied = false;
+    if(this->dmivalid
+    and start <= this->dmi.get_end_address()
+    and end   >= this->dmi.get_start_address())
+        this->dmivalid = false;
 }
 
 } // namespace core
@@ -19,14 +19,31 @@ class Master
         void WriteWord(sc_dt::uint64 addr, unsigned int* word);
         void ReadWord( sc_dt::uint64 addr, unsigned int* word);
 
+        // Transfer count consecutive words with a single transaction.
+        // beatgap is the time the initiator spends between two words.
+        void WriteBurst(sc_dt::uint64 addr, unsigned int* words, unsigned int count, sc_core::sc_time beatgap = sc_core::SC_ZERO_TIME);
+        void ReadBurst( sc_dt::uint64 addr, unsigned int* words, unsigned int count, sc_core::sc_time beatgap = sc_core::SC_ZERO_TIME);
+
+        // With DMI enabled, accesses to targets that grant a DMI pointer
+        // bypass the interconnect. Only the access latency of the target gets simulated.
+        void EnableDMI(bool enable=true);
+
         tlm::tlm_initiator_socket<> initiator_socket;
 
     protected:
         virtual void Execute() = 0;
 
     private:
+        void Burst(tlm::tlm_command command, sc_dt::uint64 addr, unsigned int* words, unsigned int count, sc_core::sc_time beatgap);
+        bool DirectAccess(tlm::tlm_command command, sc_dt::uint64 addr, unsigned int* words, unsigned int count, sc_core::sc_time beatgap);
+
         virtual tlm::tlm_sync_enum nb_transport_bw(tlm::tlm_generic_payload&, tlm::tlm_phase&, sc_core::sc_time&);
-        virtual void invalidate_direct_mem_ptr(sc_dt::uint64, sc_dt::uint64);
+        virtual void invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end);
+
+        bool         dmienabled;
+        bool         dmivalid;  // true when dmi describes a granted region
+        bool         dmidenied; // The target refused DMI. It gets requested again after an invalidation.
+        tlm::tlm_dmi dmi;
 };
 
 }
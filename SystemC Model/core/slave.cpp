@@ -1,4 +1,5 @@
 #include <core/slave.hpp>
+#include <core/burstextension.hpp>
 #include <iostream>
 
 namespace core
@@ -26,33 +27,47 @@ void Slave::b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay
         trans.set_response_status(tlm::TLM_BYTE_ENABLE_ERROR_RESPONSE);
         return;
     }
-    else if(width != 4)
+    else if(data_length == 0 or data_length % 4 != 0)
     {
-        std::cerr << "\e[1;31m" << this->name() << ": "  << "\e[1;31mInvalid streaming_width! Must always be 4" << std::endl;
+        std::cerr << "\e[1;31m" << this->name() << ": "  << "\e[1;31mInvalid data_length! Must be a multiple of 4" << std::endl;
         trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
         return;
     }
-    else if(data_length != 4)
+    else if(width != data_length)
     {
-        std::cerr << "\e[1;31m" << this->name() << ": "  << "\e[1;31mInvalid data_length! Must always be 4" << std::endl;
+        std::cerr << "\e[1;31m" << this->name() << ": "  << "\e[1;31mInvalid streaming_width! Must always be equal to data_length" << std::endl;
         trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
         return;
     }
 
-    switch(trans.get_command())
+    BurstExtension *burst;
+    trans.get_extension(burst);
+
+    // Each address addresses a whole word. A burst accesses consecutive addresses.
+    unsigned int words = data_length / 4;
+    for(unsigned int i = 0; i < words; i++)
     {
-        case tlm::TLM_WRITE_COMMAND:
-            this->Write(address, *data);
-            break;
-
-        case tlm::TLM_READ_COMMAND:
-            *data = this->Read(address);
-            break;
-
-        case tlm::TLM_IGNORE_COMMAND:
-        default:
-            std::cerr << "\e[1;31m" << this->name() << ": "  << "\e[1;31mInvalid command!" << std::endl;
-            break;
+        if(i > 0 and burst != nullptr and burst->observer == nullptr and burst->beatgap != sc_core::SC_ZERO_TIME)
+            sc_core::wait(burst->beatgap);
+
+        switch(trans.get_command())
+        {
+            case tlm::TLM_WRITE_COMMAND:
+                this->Write(address + i, data[i]);
+                break;
+
+            case tlm::TLM_READ_COMMAND:
+                data[i] = this->Read(address + i);
+                break;
+
+            case tlm::TLM_IGNORE_COMMAND:
+            default:
+                std::cerr << "\e[1;31m" << this->name() << ": "  << "\e[1;31mInvalid command!" << std::endl;
+                break;
+        }
+
+        if(burst != nullptr and burst->observer != nullptr)
+            burst->observer->EndOfBeat(trans.get_command(), i + 1 < words ? burst->beatgap : sc_core::SC_ZERO_TIME);
     }
 
     trans.set_response_status(tlm::TLM_OK_RESPONSE);
@@ -71,6 +86,11 @@ bool Slave::get_direct_mem_ptr(tlm::tlm_generic_payload&, tlm::tlm_dmi&)
     return false; 
 }
 
+void Slave::InvalidateDirectMemPtr(sc_dt::uint64 start, sc_dt::uint64 end)
+{
+    this->target_socket->invalidate_direct_mem_ptr(start, end);
+}
+
 unsigned int Slave::transport_dbg(tlm::tlm_generic_payload&)
 {
     std::cerr << "\e[0;33mtransport_dbg called" << std::endl;
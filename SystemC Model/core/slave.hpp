@@ -22,6 +22,11 @@ class Slave
         virtual unsigned long Read(uint64_t address) const = 0;
         virtual void Write(uint64_t address, unsigned long word) = 0;
 
+    protected:
+        // Tell all initiators that previously granted DMI pointers
+        // for the address range [start, end] are no longer valid.
+        void InvalidateDirectMemPtr(sc_dt::uint64 start, sc_dt::uint64 end);
+
     private:
         int CheckIndex(int index);
         virtual void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
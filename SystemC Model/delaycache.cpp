@@ -0,0 +1,238 @@
+#include <delaycache.hpp>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+static const char   MAGIC[8]      = {'S', 'M', 'C', 'D', 'E', 'L', 'A', 'Y'};
+static const size_t HEADERSIZE    = 64;
+static const char   FITMAGIC[8]   = {'S', 'M', 'C', 'D', 'F', 'I', 'T', '\0'};
+static const size_t FITHEADERSIZE = 40;
+
+DelayCache::DelayCache()
+{
+    const char *home = secure_getenv("HOME");
+    if(home == nullptr)
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m HOME not set. \e[1;30m(Delay vector cache disabled)\e[0m\n";
+        return;
+    }
+
+    std::string cachepath = std::string(home) + "/.smcdelaycache";
+
+    // Try to create cache directory
+    int status = mkdir(cachepath.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+    if(status != 0 and errno != EEXIST)
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Failed to create \""
+                  << cachepath << "\" - "
+                  << strerror(errno)
+                  << " \e[1;30m(Delay vector cache disabled)\e[0m\n";
+        return;
+    }
+
+    this->directory = cachepath;
+}
+
+
+
+bool DelayCache::IsAvailable() const
+{
+    return not this->directory.empty();
+}
+
+
+
+uint64_t DelayCache::Hash(const void *data, size_t length, uint64_t hash)
+{
+    const uint8_t *bytes = static_cast<const uint8_t*>(data);
+    for(size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+
+
+std::string DelayCache::EntryPath(uint64_t key, const char *extension) const
+{
+    std::ostringstream path;
+    path << this->directory << "/" << std::hex << std::setw(16) << std::setfill('0') << key << extension;
+    return path.str();
+}
+
+
+
+// The binary layout is written field by field,
+// so the files do not depend on structure padding.
+
+template<typename T>
+static void PutValue(std::vector<char> &buffer, T value)
+{
+    const char *bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+static T GetValue(const char *buffer)
+{
+    T value;
+    std::memcpy(&value, buffer, sizeof(T));
+    return value;
+}
+
+
+
+bool DelayCache::Load(uint64_t key, CachedDelays &entry) const
+{
+    if(not this->IsAvailable())
+        return false;
+
+    std::ifstream file(this->EntryPath(key), std::ios::binary | std::ios::ate);
+    if(not file.is_open())
+        return false;
+
+    std::streamoff filesize = file.tellg();
+    if(filesize < static_cast<std::streamoff>(HEADERSIZE))
+        return false;
+    file.seekg(0);
+
+    char header[HEADERSIZE];
+    file.read(header, HEADERSIZE);
+
+    uint64_t count = GetValue<uint64_t>(header + 24);
+    if(std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0
+    or GetValue<uint32_t>(header + 8)  != DelayCache::VERSION
+    or GetValue<uint64_t>(header + 16) != key
+    or static_cast<uint64_t>(filesize) != HEADERSIZE + count * sizeof(double))
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Ignoring invalid delay cache entry " << this->EntryPath(key) << "\n";
+        return false;
+    }
+
+    entry.BCET  = GetValue<double>(header + 32);
+    entry.WCET  = GetValue<double>(header + 40);
+    entry.mu    = GetValue<double>(header + 48);
+    entry.sigma = GetValue<double>(header + 56);
+    entry.delays.resize(count);
+    file.read(reinterpret_cast<char*>(entry.delays.data()), count * sizeof(double));
+
+    return file.good();
+}
+
+
+
+void DelayCache::Store(uint64_t key, const CachedDelays &entry) const
+{
+    if(not this->IsAvailable())
+        return;
+
+    std::vector<char> header;
+    header.reserve(HEADERSIZE);
+    header.insert(header.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    PutValue<uint32_t>(header, DelayCache::VERSION);
+    PutValue<uint32_t>(header, 0);
+    PutValue<uint64_t>(header, key);
+    PutValue<uint64_t>(header, entry.delays.size());
+    PutValue<double>(header, entry.BCET);
+    PutValue<double>(header, entry.WCET);
+    PutValue<double>(header, entry.mu);
+    PutValue<double>(header, entry.sigma);
+
+    this->WriteEntry(this->EntryPath(key), header, entry.delays);
+}
+
+
+
+bool DelayCache::Load(uint64_t key, CachedFit &entry) const
+{
+    if(not this->IsAvailable())
+        return false;
+
+    std::ifstream file(this->EntryPath(key, ".fit"), std::ios::binary | std::ios::ate);
+    if(not file.is_open())
+        return false;
+
+    std::streamoff filesize = file.tellg();
+    if(filesize < static_cast<std::streamoff>(FITHEADERSIZE))
+        return false;
+    file.seekg(0);
+
+    char header[FITHEADERSIZE];
+    file.read(header, FITHEADERSIZE);
+
+    uint64_t count = GetValue<uint64_t>(header + 32);
+    if(std::memcmp(header, FITMAGIC, sizeof(FITMAGIC)) != 0
+    or GetValue<uint32_t>(header + 8)  != DelayCache::FITVERSION
+    or GetValue<uint64_t>(header + 16) != key
+    or static_cast<uint64_t>(filesize) != FITHEADERSIZE + count * sizeof(double))
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Ignoring invalid delay cache entry " << this->EntryPath(key, ".fit") << "\n";
+        return false;
+    }
+
+    entry.family     = GetValue<int32_t>(header + 12);
+    entry.ksdistance = GetValue<double>(header + 24);
+    entry.parameters.resize(count);
+    file.read(reinterpret_cast<char*>(entry.parameters.data()), count * sizeof(double));
+
+    return file.good();
+}
+
+
+
+void DelayCache::Store(uint64_t key, const CachedFit &entry) const
+{
+    if(not this->IsAvailable())
+        return;
+
+    std::vector<char> header;
+    header.reserve(FITHEADERSIZE);
+    header.insert(header.end(), FITMAGIC, FITMAGIC + sizeof(FITMAGIC));
+    PutValue<uint32_t>(header, DelayCache::FITVERSION);
+    PutValue<int32_t>(header, entry.family);
+    PutValue<uint64_t>(header, key);
+    PutValue<double>(header, entry.ksdistance);
+    PutValue<uint64_t>(header, entry.parameters.size());
+
+    this->WriteEntry(this->EntryPath(key, ".fit"), header, entry.parameters);
+}
+
+
+
+void DelayCache::WriteEntry(const std::string &path, const std::vector<char> &header, const std::vector<double> &values) const
+{
+    // Each process and thread writes its own temporary file
+    static std::atomic<unsigned int> stores(0);
+    std::string temporarypath = path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(stores++);
+
+    std::ofstream file(temporarypath, std::ios::binary | std::ios::trunc);
+    file.write(header.data(), header.size());
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+    file.close();
+
+    if(file.fail())
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Writing delay cache entry " << temporarypath << " failed\n";
+        std::remove(temporarypath.c_str());
+        return;
+    }
+
+    if(std::rename(temporarypath.c_str(), path.c_str()) != 0)
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Storing delay cache entry " << path << " failed - " << strerror(errno) << "\n";
+        std::remove(temporarypath.c_str());
+    }
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,83 @@
+#ifndef DELAYCACHE_HPP
+#define DELAYCACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A processed delay vector with its properties, as stored in the cache
+struct CachedDelays
+{
+    double BCET;
+    double WCET;
+    double mu;
+    double sigma;
+    std::vector<double> delays;
+};
+
+// A parametric distribution fitted to a delay vector, as stored in the cache
+struct CachedFit
+{
+    int32_t             family;     // FAMILY
+    double              ksdistance;
+    std::vector<double> parameters;
+};
+
+
+
+// Content addressed cache for processed delay vectors in ~/.smcdelaycache
+//
+// The key is a hash over the content of the timing file and all parameters of the processing.
+// Each entry is a binary file named after its key (all integers little endian):
+//
+//   offset  size  content
+//    0      8     magic "SMCDELAY"
+//    8      4     cache format version
+//   12      4     reserved (0)
+//   16      8     key
+//   24      8     number of delays n
+//   32      8*4   BCET, WCET, mu, sigma (double)
+//   64      8*n   delays (double)
+//
+// Fitted distributions are stored in their own entries, named after their key with the extension .fit:
+//
+//   offset  size  content
+//    0      8     magic "SMCDFIT\0"
+//    8      4     fit format version
+//   12      4     family
+//   16      8     key
+//   24      8     KS distance (double)
+//   32      8     number of parameters n
+//   40      8*n   parameters (double)
+//
+// Entries get written into a temporary file that gets renamed afterwards.
+// So concurrent simulations never read partial entries, and the last writer wins.
+
+class DelayCache
+{
+    public:
+        DelayCache();
+
+        // Returns false if the cache is not available
+        bool IsAvailable() const;
+
+        bool Load( uint64_t key, CachedDelays &entry) const;
+        void Store(uint64_t key, const CachedDelays &entry) const;
+        bool Load( uint64_t key, CachedFit &entry) const;
+        void Store(uint64_t key, const CachedFit &entry) const;
+
+        // FNV-1a 64 bit hash, continuing from hash
+        static uint64_t Hash(const void *data, size_t length, uint64_t hash = 0xcbf29ce484222325ULL);
+
+        static const uint32_t VERSION    = 2;   // Increment when the processing of delay vectors changes
+        static const uint32_t FITVERSION = 1;   // Increment when the fitting changes
+
+    private:
+        std::string EntryPath(uint64_t key, const char *extension = ".bin") const;
+        void WriteEntry(const std::string &path, const std::vector<char> &header, const std::vector<double> &values) const;
+
+        std::string directory;  // Empty if the cache is not available
+};
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
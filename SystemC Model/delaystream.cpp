@@ -0,0 +1,341 @@
+#include <delaystream.hpp>
+#include <timingfile.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+DelayStream::DelayStream(const std::string &path, uint64_t offset, bool shuffle, uint64_t seed)
+    : path(path)
+    , valid(false)
+    , shuffle(shuffle)
+    , seed(seed)
+    , binary(false)
+    , fd(-1)
+    , width(0)
+    , count(0)
+    , fileindex(0)
+    , invalidlines(0)
+    , chunknumber(offset / DelayStream::CHUNKSIZE)
+    , position(0)
+    , nextready(false)
+    , stop(false)
+{
+    this->valid = this->OpenBinary() or (not this->binary and this->OpenText());
+    if(not this->valid)
+        return;
+
+    // Chunks always get filled completely, so the offset can be split into chunks and a position inside a chunk.
+    // The first chunk gets read right now, the next one by the prefetcher.
+    // The prefetcher starts with the first Read, so the stream can be opened before the process forks.
+    this->Skip(this->chunknumber * DelayStream::CHUNKSIZE);
+    if(not this->valid)
+        return;
+
+    try
+    {
+        this->ReadChunk(this->current);
+    }
+    catch(const std::runtime_error &e)
+    {
+        this->valid = false;
+        return;
+    }
+    this->position = offset % DelayStream::CHUNKSIZE;
+}
+
+
+
+DelayStream::~DelayStream()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stop = true;
+    }
+    this->condition.notify_all();
+    if(this->prefetcher.joinable())
+        this->prefetcher.join();
+
+    if(this->fd >= 0)
+        close(this->fd);
+
+    if(this->invalidlines > 0)
+        std::cerr << "\e[1;33mWARNING:\e[0m " << this->invalidlines << " lines of " << this->path
+                  << " could not be parsed and were ignored\n";
+}
+
+
+
+bool DelayStream::IsValid() const
+{
+    return this->valid;
+}
+
+bool DelayStream::IsBinary() const
+{
+    return this->binary;
+}
+
+
+
+bool DelayStream::OpenBinary()
+{
+    int fd = open(this->path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    TimingFileHeader header;
+    struct stat filestat;
+    if(pread(fd, &header, sizeof(header), 0) != sizeof(header)
+    or std::memcmp(header.magic, TIMINGFILE_MAGIC, sizeof(TIMINGFILE_MAGIC)) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    // From here on, the file is a binary timing file and must not be parsed as text
+    this->binary = true;
+    if(header.flags & TIMINGFILE_SHUFFLED)
+    {
+        close(fd);
+        std::cerr << "\e[1;31mERROR:\e[0m " << this->path << " is shuffled and can not be streamed in the order of the measurements"
+                  << " \e[1;30m(Stream the text timing file instead)\e[0m\n";
+        return false;
+    }
+
+    if(header.version != TIMINGFILE_VERSION
+    or (header.width != 4 and header.width != 8)
+    or header.count == 0
+    or fstat(fd, &filestat) != 0
+    or static_cast<uint64_t>(filestat.st_size) != sizeof(TimingFileHeader) + header.count * header.width)
+    {
+        close(fd);
+        std::cerr << "\e[1;31mERROR:\e[0m Invalid timing file " << this->path << "\n";
+        return false;
+    }
+
+    this->fd     = fd;
+    this->width  = header.width;
+    this->count  = header.count;
+    return true;
+}
+
+
+
+bool DelayStream::OpenText()
+{
+    this->textfile.open(this->path);
+    if(not this->textfile.good())
+    {
+        std::cerr << "\e[1;33mMissing data: \e[1;34m" << this->path << "\e[0m\n";
+        return false;
+    }
+    return true;
+}
+
+
+
+void DelayStream::Rewind()
+{
+    if(this->binary)
+    {
+        this->fileindex = 0;
+    }
+    else
+    {
+        this->textfile.clear();
+        this->textfile.seekg(0);
+    }
+}
+
+
+
+size_t DelayStream::ReadDelays(double *buffer, size_t count)
+{
+    if(this->binary)
+    {
+        count = std::min<uint64_t>(count, this->count - this->fileindex);
+
+        // Read the raw values into the end of the buffer and widen them in place from the front
+        size_t bytes  = count * this->width;
+        char  *target = reinterpret_cast<char*>(buffer + count) - bytes;
+        off_t  offset = sizeof(TimingFileHeader) + this->fileindex * this->width;
+        size_t done   = 0;
+        while(done < bytes)
+        {
+            ssize_t result = pread(this->fd, target + done, bytes - done, offset + done);
+            if(result <= 0)
+            {
+                std::cerr << "\e[1;31mERROR:\e[0m Reading " << this->path << " failed - " << strerror(errno) << "\n";
+                throw std::runtime_error("Reading timing file failed!");
+            }
+            done += result;
+        }
+
+        if(this->width == 4)
+        {
+            const uint32_t *values = reinterpret_cast<const uint32_t*>(target);
+            for(size_t i = 0; i < count; i++)
+                buffer[i] = values[i];
+        }
+
+        this->fileindex += count;
+        return count;
+    }
+
+    size_t read = 0;
+    for(std::string line; read < count and std::getline(this->textfile, line); )
+    {
+        char  *end;
+        double delay = std::strtod(line.c_str(), &end);
+        if(end == line.c_str())
+        {
+            this->invalidlines++;
+            continue;
+        }
+        buffer[read++] = delay;
+    }
+    return read;
+}
+
+
+
+// The chunk always gets filled completely. At the end of the file, reading continues at the beginning.
+void DelayStream::ReadChunk(std::vector<double> &chunk)
+{
+    chunk.resize(DelayStream::CHUNKSIZE);
+
+    size_t filled = 0;
+    bool   rewound = false;
+    while(filled < chunk.size())
+    {
+        size_t read = this->ReadDelays(chunk.data() + filled, chunk.size() - filled);
+        if(read == 0)
+        {
+            if(rewound)     // A whole pass without any delay
+            {
+                std::cerr << "\e[1;31mERROR:\e[0m " << this->path << " contains no delays!\n";
+                throw std::runtime_error("Streaming timing file failed!");
+            }
+            this->Rewind();
+            rewound = true;
+            continue;
+        }
+        filled += read;
+        rewound = false;
+    }
+
+    if(this->shuffle)
+        ShuffleDelays(chunk, this->seed ^ (this->chunknumber * 0x9E3779B97F4A7C15ULL));
+    this->chunknumber++;
+}
+
+
+
+// Binary files can be positioned directly. Text files need to be read up to the offset,
+// but only once: After the first pass, the number of delays is known.
+void DelayStream::Skip(uint64_t count)
+{
+    if(this->binary)
+    {
+        this->fileindex = count % this->count;
+        return;
+    }
+
+    std::vector<double> buffer(std::min<uint64_t>(count, DelayStream::CHUNKSIZE));
+    uint64_t skipped   = 0;
+    uint64_t filecount = 0;     // 0 while unknown
+    while(count > 0)
+    {
+        if(filecount > 0 and count >= filecount)
+            count %= filecount;
+        if(count == 0)
+            break;
+
+        size_t read = this->ReadDelays(buffer.data(), std::min<uint64_t>(count, buffer.size()));
+        if(read == 0)
+        {
+            if(skipped == 0)
+            {
+                std::cerr << "\e[1;31mERROR:\e[0m " << this->path << " contains no delays!\n";
+                this->valid = false;
+                return;
+            }
+            filecount = skipped;
+            this->Rewind();
+            continue;
+        }
+        count   -= read;
+        skipped += read;
+    }
+}
+
+
+
+// Runs in its own thread and reads the next chunk whenever the simulation started using the current one
+void DelayStream::Prefetch()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while(true)
+    {
+        this->condition.wait(lock, [this]() { return this->stop or not this->nextready; });
+        if(this->stop)
+            return;
+
+        lock.unlock();
+        std::exception_ptr error;
+        try
+        {
+            this->ReadChunk(this->next);
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+        }
+        lock.lock();
+
+        this->error     = error;
+
+        this->nextready = true;
+        this->condition.notify_all();
+        if(error)
+            return;
+    }
+}
+
+
+
+void DelayStream::Read(double *buffer, size_t count)
+{
+    if(not this->prefetcher.joinable())
+        this->prefetcher = std::thread(&DelayStream::Prefetch, this);
+
+    while(count > 0)
+    {
+        if(this->position == this->current.size())
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->condition.wait(lock, [this]() { return this->nextready; });
+            if(this->error)
+                std::rethrow_exception(this->error);
+            std::swap(this->current, this->next);
+            this->position  = 0;
+            this->nextready = false;
+            lock.unlock();
+            this->condition.notify_all();
+        }
+
+        size_t available = std::min(count, this->current.size() - this->position);
+        std::copy_n(this->current.data() + this->position, available, buffer);
+        this->position += available;
+        buffer         += available;
+        count          -= available;
+    }
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,76 @@
+#ifndef DELAYSTREAM_HPP
+#define DELAYSTREAM_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streams measured delays from a timing file of any length with constant memory.
+//
+// The delays get read in chunks by a background thread. While the simulation consumes one chunk,
+// the thread already reads the next one (double buffering), so the simulation does not wait for I/O.
+// The thread gets started by the first Read. Until then, the process can be forked safely.
+// At the end of the file, the stream continues at the beginning, like the injected delay vector does.
+//
+// Text timing files (one delay per line) and binary timing files (see timingfile.hpp) are supported.
+// The delays get streamed in the order of the measurements, so shuffled binary timing files get refused.
+// Optionally, each chunk gets shuffled. The permutation only depends on the seed and the chunk number.
+
+class DelayStream
+{
+    public:
+        static const size_t CHUNKSIZE = 1 << 16;    // delays per chunk
+
+        // offset: Number of delays to skip
+        DelayStream(const std::string &path, uint64_t offset = 0, bool shuffle = false, uint64_t seed = 0);
+        ~DelayStream();
+
+        // false if the file can not be read or contains no delays
+        bool IsValid() const;
+        bool IsBinary() const;
+
+        void Read(double *buffer, size_t count);
+
+    private:
+        bool OpenBinary();
+        bool OpenText();
+        void Rewind();
+        void ReadChunk(std::vector<double> &chunk);   // Reads and shuffles the next chunk
+        size_t ReadDelays(double *buffer, size_t count); // Reads up to count delays, 0 at the end of the file
+        void Skip(uint64_t count);
+        void Prefetch();
+
+        std::string path;
+        bool        valid;
+        bool        shuffle;
+        uint64_t    seed;
+
+        // File
+        bool          binary;
+        int           fd;           // binary timing file
+        uint32_t      width;        // 4 (uint32_t) or 8 (double)
+        uint64_t      count;        // number of delays in the binary file
+        uint64_t      fileindex;    // next delay in the binary file
+        std::ifstream textfile;
+        uint64_t      invalidlines;
+        uint64_t      chunknumber;  // of the next chunk that gets read
+
+        // Double buffer
+        std::vector<double> current;
+        std::vector<double> next;
+        size_t              position;   // in current
+        bool                nextready;
+        bool                stop;
+        std::exception_ptr  error;      // of the prefetcher, rethrown by Read
+        std::mutex              mutex;
+        std::condition_variable condition;
+        std::thread             prefetcher;
+};
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
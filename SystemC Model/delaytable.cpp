@@ -0,0 +1,106 @@
+#include <delaytable.hpp>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+DelayTable::DelayTable(std::string path)
+    : path(path)
+    , loaded(false)
+{
+}
+
+
+
+bool DelayTable::Load()
+{
+    if(this->loaded)
+        return true;
+
+    std::ifstream file(this->path);
+    if(not file.good())
+        return false;
+
+    std::vector<double> delays;
+    std::vector<bool>   defined;
+    size_t linenumber = 0;
+    for(std::string line; std::getline(file, line); )
+    {
+        linenumber++;
+
+        std::istringstream fields(line);
+        std::string first;
+        if(not (fields >> first) or first[0] == '#')
+            continue;
+
+        size_t key;
+        double delay;
+        try
+        {
+            key = std::stoul(first);
+        }
+        catch(std::exception &e)
+        {
+            key = SIZE_MAX;
+        }
+        if(key == SIZE_MAX or not (fields >> delay) or delay < 0.0)
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m Invalid line " << linenumber << " in delay table " << this->path
+                      << ": \"" << line << "\" \e[1;30m(Expected key and delay)\e[0m\n";
+            throw std::runtime_error("Loading delay table failed!");
+        }
+
+        if(key >= delays.size())
+        {
+            delays.resize( key + 1, 0.0);
+            defined.resize(key + 1, false);
+        }
+        if(defined[key])
+            std::cerr << "\e[1;33mWARNING:\e[0m Key " << key << " defined twice in delay table " << this->path
+                      << " \e[1;30m(Using line " << linenumber << ")\e[0m\n";
+        delays[key]  = delay;
+        defined[key] = true;
+    }
+
+    if(delays.empty())
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Delay table " << this->path << " is empty!\n";
+        throw std::runtime_error("Loading delay table failed!");
+    }
+    for(size_t key = 0; key < defined.size(); key++)
+    {
+        if(not defined[key])
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m Key " << key << " missing in delay table " << this->path << "!\n";
+            throw std::runtime_error("Loading delay table failed!");
+        }
+    }
+
+    // Quantize the delays the same way sc_time(delay, SC_NS) does
+    double ticksperns = static_cast<double>(sc_core::sc_time(1.0, sc_core::SC_NS).value());
+    this->ticks.resize(delays.size());
+    for(size_t key = 0; key < delays.size(); key++)
+        this->ticks[key] = static_cast<sc_dt::uint64>(delays[key] * ticksperns + 0.5);
+
+    this->loaded = true;
+    return true;
+}
+
+
+
+bool DelayTable::IsLoaded() const
+{
+    return this->loaded;
+}
+
+const std::string& DelayTable::GetPath() const
+{
+    return this->path;
+}
+
+size_t DelayTable::Size() const
+{
+    return this->ticks.size();
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,57 @@
+#ifndef DELAYTABLE_HPP
+#define DELAYTABLE_HPP
+
+#include <cassert>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <systemc.h>
+
+class DelayTable;
+typedef std::unordered_map<std::string, DelayTable*> DelayTableMap;
+
+// Data dependent delays
+//
+// An actor computes a small key from its input tokens (see Actor::DelayKey).
+// The key indexes this table of delays, loaded from a text file:
+//
+//   # key  delay in clock cycles
+//   0      1401
+//   1      1431
+//
+// Keys must cover 0 .. n-1 without gaps. Lines starting with # are comments.
+// Actor::SelectDelayTable checks that n covers all keys of the actor (Actor::DelayKeyCount).
+// The delays get converted into SystemC time values while loading,
+// so looking up a delay is a single array access.
+
+class DelayTable
+{
+    public:
+        DelayTable(std::string path);
+
+        // Returns false if the file does not exist. Loading twice does nothing.
+        // Invalid files throw a runtime error.
+        bool Load();
+        bool IsLoaded() const;
+
+        inline sc_core::sc_time GetDelay(size_t key) const;
+
+        const std::string& GetPath() const;
+        size_t Size() const;
+
+    private:
+        std::string                path;
+        std::vector<sc_dt::uint64> ticks;
+        bool                       loaded;
+};
+
+
+
+sc_core::sc_time DelayTable::GetDelay(size_t key) const
+{
+    assert(key < this->ticks.size());
+    return sc_core::sc_time::from_value(this->ticks[key]);
+}
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -1,35 +1,211 @@
 #include <delayvector.hpp>
 #include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <random>
 #include <iostream>
 //#include <filesystem>
 #include <sys/types.h>
 #include <sys/stat.h>
-#include <gsl/gsl_randist.h>
 #include <gsl/gsl_statistics_double.h>
 #include <setup/pythonwrapper.hpp>
+#include <delaycache.hpp>
+#include <timingfile.hpp>
+#include <delaystream.hpp>
+#include <unordered_map>
+#include <stdexcept>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// Parameters of the processing of delay vectors.
+// They are part of the cache key.
+const double       KDEBANDWIDTH = 0.01; // relative to the maximum delay
+const uint32_t     KDESEED      = 1;    // setup/kde.py uses numpy.random.seed(1)
+
+
+
+static DelayCache& GetDelayCache()
+{
+    static DelayCache cache;
+    return cache;
+}
 
 
-DelayVector::DelayVector(const char *path, DISTRIBUTION distribution, unsigned int offset)
-    : delayindex(0)
-    , rng(nullptr)
-    , distribution(distribution)
+DelayVector::DelayVector(const char *path, DISTRIBUTION distribution, uint64_t offset)
+    : delays(nullptr)
+    , integerdelays(nullptr)
+    , delaycount(0)
+    , mapping(nullptr)
+    , mappingsize(0)
+    , initialized(false)
+    , family(DelayVector::parametricfamily)
+    , delayindex(0)
+    , drawindex(0)
+    , tickindex(0)
+    , generated(0)
     , datapath(path)
+    , distribution(distribution)
     , offset(offset)
 {
     //this->InitializeData();
 }
 
-DelayVector::DelayVector(std::string path, DISTRIBUTION distribution, unsigned int offset)
-    : delayindex(0)
-    , rng(nullptr)
-    , distribution(distribution)
+DelayVector::DelayVector(std::string path, DISTRIBUTION distribution, uint64_t offset)
+    : delays(nullptr)
+    , integerdelays(nullptr)
+    , delaycount(0)
+    , mapping(nullptr)
+    , mappingsize(0)
+    , initialized(false)
+    , family(DelayVector::parametricfamily)
+    , delayindex(0)
+    , drawindex(0)
+    , tickindex(0)
+    , generated(0)
     , datapath(path)
+    , distribution(distribution)
     , offset(offset)
 {
     //this->InitializeData();
 }
 
+DelayVector::~DelayVector()
+{
+    if(this->mapping != nullptr)
+        munmap(this->mapping, this->mappingsize);
+}
+
 void DelayVector::InitializeData()
+{
+    this->initialized = true;
+
+    // The stream depends only on the data path, not on the order in which the delay vectors get used.
+    // So the results are reproducible for a given seed.
+    uint64_t stream = DelayCache::Hash(this->datapath.data(), this->datapath.size());
+    this->rng = CounterRNG(DelayVector::seed, stream);
+
+    if(this->distribution == DISTRIBUTION::INJECTED and DelayVector::streaming)
+    {
+        this->OpenStream();
+        return;
+    }
+
+    // The KDE needs the measured delays in their original order.
+    // Its results come from the delay cache instead.
+    bool loaded = (not this->UsesKDE() and this->MapTimingFile()) or this->ReadTimingFile();
+    if(not loaded)
+        return;
+
+    if(this->distribution == DISTRIBUTION::EMPIRICAL or this->distribution == DISTRIBUTION::EMPIRICAL_KDE)
+        this->BuildAliasTable();
+    else if(this->distribution == DISTRIBUTION::PARAMETRIC)
+        this->FitParametricDistribution();
+
+    this->SkipOffsetDelays();
+}
+
+
+
+bool DelayVector::IsInitialized() const
+{
+    return this->initialized;
+}
+
+const std::string& DelayVector::GetPath() const
+{
+    return this->datapath;
+}
+
+
+
+void DelayVector::Seek(uint64_t offset)
+{
+    this->offset    = offset;
+    this->tickindex = this->ticks.size();
+    this->generated = 0;
+
+    if(not this->initialized)
+        return;
+
+    if(this->stream)
+    {
+        this->stream.reset();
+        this->OpenStream();
+        return;
+    }
+
+    this->SkipOffsetDelays();
+}
+
+
+
+// The delays that are generated but still buffered were not used yet
+uint64_t DelayVector::GetPosition() const
+{
+    return this->offset + this->generated - (this->ticks.size() - this->tickindex);
+}
+
+
+
+// The stream uses the delays in the order of the measurements.
+// timing2bin shuffles the binary timing files, so the text file is preferred and the binary one only used without it.
+// Skipping is done by the stream.
+bool DelayVector::OpenStream()
+{
+    std::string path = this->datapath;
+    if(access(path.c_str(), R_OK) != 0)
+    {
+        if(path.size() >= 4 and path.compare(path.size() - 4, 4, ".txt") == 0)
+            path.erase(path.size() - 4);
+        path += ".bin";
+        if(access(path.c_str(), R_OK) != 0)
+            path = this->datapath;
+    }
+
+    uint64_t seed = DelayVector::seed ^ DelayCache::Hash(this->datapath.data(), this->datapath.size());
+    this->stream.reset(new DelayStream(path, this->offset, DelayVector::streamshuffle, seed));
+    if(not this->stream->IsValid())
+    {
+        this->stream.reset();
+        return false;
+    }
+
+    std::cerr << "\e[1;30mStreaming " << path;
+    if(DelayVector::streamshuffle)
+        std::cerr << " (shuffled in blocks of " << DelayStream::CHUNKSIZE << " delays)";
+    std::cerr << "\e[0m\n";
+    return true;
+}
+
+
+
+bool DelayVector::streaming     = false;
+bool DelayVector::streamshuffle = false;
+
+void DelayVector::EnableStreaming(bool enable)
+{
+    DelayVector::streaming = enable;
+}
+
+void DelayVector::EnableStreamShuffle(bool enable)
+{
+    DelayVector::streamshuffle = enable;
+}
+
+
+
+bool DelayVector::UsesKDE() const
+{
+    return this->distribution == DISTRIBUTION::GAUSSIAN_KDE or this->distribution == DISTRIBUTION::EMPIRICAL_KDE;
+}
+
+
+
+bool DelayVector::ReadTimingFile()
 {
     // Check if file exists
     ifstream f(this->datapath);
@@ -38,40 +214,257 @@ void DelayVector::InitializeData()
         std::cerr << "\e[1;33mMissing data: \e[1;34m"
                   << this->datapath
                   << "\e[0m\n";
-        return;
+        return false;
     }
-    else
-        f.close();
 
     // Read file
-    if(this->distribution == DISTRIBUTION::GAUSSIAN_KDE)
+    std::stringstream buffer;
+    buffer << f.rdbuf();
+    f.close();
+    std::string contents = buffer.str();
+
+    // Process the delays, unless this was already done by a previous simulation
+    uint64_t key = this->CacheKey(contents);
+    if(not this->LoadFromCache(key))
     {
-        this->ReadKDEFittedDelayVector();
+        if(this->UsesKDE())
+        {
+            this->ReadKDEFittedDelayVector(contents);
+        }
+        else
+        {
+            this->ReadDelayVector(contents);
+        }
+        this->StoreInCache(key);
+    }
+
+    this->delays     = this->delayvector.data();
+    this->delaycount = this->delayvector.size();
+    return true;
+}
+
+
+
+// The measured delays are integer cycle counts with only a few hundred distinct values.
+// Their histogram needs a few kilobytes instead of megabytes for the whole trace.
+void DelayVector::BuildAliasTable()
+{
+    if(this->delaycount == 0)
+        return;
+
+    std::unordered_map<double, double> histogram;
+    for(size_t i = 0; i < this->delaycount; i++)
+        histogram[this->DelayAt(i)] += 1.0;
+
+    // Sorted values make the table independent of the hash map's iteration order
+    std::vector<double> values;
+    values.reserve(histogram.size());
+    for(const auto &bin : histogram)
+        values.push_back(bin.first);
+    std::sort(values.begin(), values.end());
+
+    std::vector<double> weights;
+    weights.reserve(values.size());
+    for(double value : values)
+        weights.push_back(histogram[value]);
+
+    this->aliastable.Build(values, weights);
+    this->ReleaseDelays();
+
+    std::cerr << "\e[1;30mEmpirical distribution of " << this->datapath << ": "
+              << this->aliastable.Size() << " distinct delays ("
+              << this->aliastable.MemoryUsage() / 1024 << " KiB)\e[0m\n";
+}
+
+
+
+// Fitting needs all measured delays and takes a moment.
+// So the fitted parameters get cached as well.
+void DelayVector::FitParametricDistribution()
+{
+    if(this->delaycount == 0)
+        return;
+
+    std::vector<double> samples(this->delaycount);
+    for(size_t i = 0; i < this->delaycount; i++)
+        samples[i] = this->DelayAt(i);
+
+    uint64_t  key = this->FitCacheKey(samples);
+    CachedFit entry;
+    if(DelayVector::usecache and GetDelayCache().Load(key, entry)
+    and entry.family > FAMILY::AUTOMATIC and entry.family <= FAMILY::GAUSSIANMIXTURE)
+    {
+        this->parametric = ParametricDistribution(static_cast<FAMILY>(entry.family), entry.parameters);
+        std::cerr << "\e[1;30mLoaded fitted distribution of " << this->datapath << " from delay cache\e[0m\n";
     }
     else
     {
-        this->ReadDelayVector();
+        std::vector<FitResult> candidates;
+        FitResult result = FitDistribution(samples, this->family, &candidates);
+        if(result.ksdistance >= 1.0)
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m Fitting a " << ParametricDistribution::FamilyName(this->family)
+                      << " distribution to " << this->datapath << " failed!\n";
+            throw std::runtime_error("Fitting parametric distribution failed!");
+        }
+
+        for(const FitResult &candidate : candidates)
+            std::cerr << "\e[1;30m    " << candidate.distribution.ToString()
+                      << ": KS distance " << candidate.ksdistance << "\e[0m\n";
+        this->parametric = result.distribution;
+
+        entry.family     = result.distribution.GetFamily();
+        entry.ksdistance = result.ksdistance;
+        entry.parameters = result.distribution.GetParameters();
+        if(DelayVector::usecache)
+            GetDelayCache().Store(key, entry);
     }
-    this->rng = gsl_rng_alloc(gsl_rng_default);
-    // By default, the random number generator gets seeded with 0
-    // This shall not be changed to get reproducible results
+
+    this->ReleaseDelays();
+
+    std::cerr << "\e[1;34mFitted distribution of " << this->datapath << ": "
+              << this->parametric.ToString() << "\e[0m\n";
+}
+
+
+
+FAMILY DelayVector::parametricfamily = FAMILY::AUTOMATIC;
+
+void DelayVector::SetParametricFamily(FAMILY family)
+{
+    DelayVector::parametricfamily = family;
+}
+
+FAMILY DelayVector::GetParametricFamily()
+{
+    return DelayVector::parametricfamily;
+}
+
+
+
+void DelayVector::ReleaseDelays()
+{
+    std::vector<double>().swap(this->delayvector);
+    if(this->mapping != nullptr)
+        munmap(this->mapping, this->mappingsize);
+
+    this->mapping       = nullptr;
+    this->mappingsize   = 0;
+    this->delays        = nullptr;
+    this->integerdelays = nullptr;
+    this->delaycount    = 0;
 }
 
 
 
-sc_core::sc_time DelayVector::GetDelay()
+// Binary timing files (see timingfile.hpp) are expected next to the text files,
+// with .bin instead of .txt as extension.
+bool DelayVector::MapTimingFile()
 {
-    // When this function gets called the first time,
-    // the delay vector gets read from the file.
-    // This is done here to avoid loading lots of data
-    // that will never be used during the simulation.
-    if(this->delayvector.empty())
+    std::string path = this->datapath;
+    if(path.size() >= 4 and path.compare(path.size() - 4, 4, ".txt") == 0)
+        path.erase(path.size() - 4);
+    path += ".bin";
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat filestat;
+    if(fstat(fd, &filestat) != 0 or static_cast<size_t>(filestat.st_size) < sizeof(TimingFileHeader))
     {
+        close(fd);
+        std::cerr << "\e[1;33mWARNING:\e[0m Invalid timing file " << path << " \e[1;30m(Ignoring it)\e[0m\n";
+        return false;
+    }
+
+    size_t size = filestat.st_size;
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Mapping " << path << " failed - " << strerror(errno) << " \e[1;30m(Ignoring it)\e[0m\n";
+        return false;
+    }
+
+    const TimingFileHeader *header = static_cast<const TimingFileHeader*>(mapping);
+    if(std::memcmp(header->magic, TIMINGFILE_MAGIC, sizeof(TIMINGFILE_MAGIC)) != 0
+    or header->version != TIMINGFILE_VERSION
+    or (header->width != 4 and header->width != 8)
+    or header->count == 0
+    or size != sizeof(TimingFileHeader) + header->count * header->width)
+    {
+        munmap(mapping, size);
+        std::cerr << "\e[1;33mWARNING:\e[0m Invalid timing file " << path << " \e[1;30m(Ignoring it)\e[0m\n";
+        return false;
+    }
+
+    this->BCET  = header->minimum;
+    this->WCET  = header->maximum;
+    this->mu    = header->mean;
+    this->sigma = header->standarddeviation;
+
+    const void *data = static_cast<const char*>(mapping) + sizeof(TimingFileHeader);
+
+    if(header->flags & TIMINGFILE_SHUFFLED)
+    {
+        // The delays can be used directly from the shared mapping
+        this->mapping     = mapping;
+        this->mappingsize = size;
+        this->delaycount  = header->count;
+        if(header->width == 4)
+            this->integerdelays = static_cast<const uint32_t*>(data);
+        else
+            this->delays        = static_cast<const double*>(data);
+    }
+    else
+    {
+        // Unshuffled delays need a private copy
+        this->delayvector.resize(header->count);
+        for(size_t i = 0; i < header->count; i++)
+        {
+            if(header->width == 4)
+                this->delayvector[i] = static_cast<const uint32_t*>(data)[i];
+            else
+                this->delayvector[i] = static_cast<const double*>(data)[i];
+        }
+        munmap(mapping, size);
+        ShuffleDelays(this->delayvector);
+
+        this->delays     = this->delayvector.data();
+        this->delaycount = this->delayvector.size();
+    }
+
+    std::cerr << "\e[1;30mUsing binary timing file " << path << "\e[0m\n";
+    return true;
+}
+
+
+
+inline double DelayVector::DelayAt(size_t index) const
+{
+    if(this->integerdelays != nullptr)
+        return this->integerdelays[index];
+    return this->delays[index];
+}
+
+
+
+// Generates the next block of delays
+// All distributions produce the same sequence of delays as if they were drawn one by one.
+void DelayVector::RefillTicks()
+{
+    if(not this->initialized)
         this->InitializeData();
-        this->GenerateOffsetDelays();
+
+    if(this->ticks.empty())
+    {
+        this->ticks.resize(  DelayVector::TICKBUFFERSIZE);
+        this->scratch.resize(DelayVector::TICKBUFFERSIZE * 2);
     }
 
-    double delay;
+    double *buffer = this->scratch.data();
+    size_t  count  = this->ticks.size();
 
     // The KDE just fits the data to a set of steady functions.
     // After fitting, the result is still a vector of delays,
@@ -80,90 +473,171 @@ sc_core::sc_time DelayVector::GetDelay()
     {
         case DISTRIBUTION::INJECTED:
         case DISTRIBUTION::GAUSSIAN_KDE:
-            delay = this->GetInjectedDelay();
+            this->GenerateInjectedDelays(buffer, count);
             break;
 
         case DISTRIBUTION::GAUSSIAN:
-            delay = this->GetGaussianDelay();
+            this->GenerateGaussianDelays(buffer, count);
             break;
 
         case DISTRIBUTION::UNIFORM:
-            delay = this->GetUniformDelay();
+            this->GenerateUniformDelays(buffer, count);
+            break;
+
+        case DISTRIBUTION::EMPIRICAL:
+        case DISTRIBUTION::EMPIRICAL_KDE:
+            this->GenerateEmpiricalDelays(buffer, count);
+            break;
+
+        case DISTRIBUTION::PARAMETRIC:
+            this->GenerateParametricDelays(buffer, count);
             break;
 
         case DISTRIBUTION::WCET:
-            delay = this->GetWCETDelay();
+            this->GenerateConstantDelays(buffer, count, this->WCET);
             break;
 
         case DISTRIBUTION::AVERAGE:
-            delay = this->GetAverageDelay();
+            this->GenerateConstantDelays(buffer, count, this->mu);
             break;
     }
 
-    return sc_core::sc_time(delay, sc_core::SC_NS);
+    // Quantize the delays the same way sc_time(delay, SC_NS) does.
+    // Negative delays (possible with the gaussian model) get clamped to 0.
+    double ticksperns = static_cast<double>(sc_core::sc_time(1.0, sc_core::SC_NS).value());
+    for(size_t i = 0; i < count; i++)
+    {
+        double delay = buffer[i] > 0.0 ? buffer[i] : 0.0;
+        this->ticks[i] = static_cast<sc_dt::uint64>(delay * ticksperns + 0.5);
+    }
+
+    this->tickindex  = 0;
+    this->generated += count;
 }
 
 
-void DelayVector::GenerateOffsetDelays()
+
+// Skipping n delays has the same effect as calling GetDelay n times:
+// The injected delays get accessed round robin, and the random numbers are addressed by a counter.
+// The WCET and average models do not have any state.
+void DelayVector::SkipOffsetDelays()
 {
-    for(unsigned int i=0; i<offset; i++)
-        this->GetDelay();
+    if(this->delaycount > 0)
+        this->delayindex = this->offset % this->delaycount;
+    this->drawindex = this->offset;
     return;
 }
 
 
-double DelayVector::GetInjectedDelay()
+
+uint64_t DelayVector::seed = 0;
+
+void DelayVector::SetSeed(uint64_t seed)
+{
+    DelayVector::seed = seed;
+}
+
+
+void DelayVector::GenerateInjectedDelays(double *buffer, size_t count)
 {
-    double delay = this->delayvector[this->delayindex];
-    this->delayindex = (this->delayindex + 1) % this->delayvector.size();
+    if(this->stream)
+    {
+        this->stream->Read(buffer, count);
+        return;
+    }
+
+    if(this->delaycount == 0)   // Missing data
+    {
+        std::fill(buffer, buffer + count, 0.0);
+        return;
+    }
 
-    return delay;
+    for(size_t i = 0; i < count; i++)
+    {
+        buffer[i] = this->DelayAt(this->delayindex);
+        this->delayindex = (this->delayindex + 1) % this->delaycount;
+    }
 }
 
 
 
-double DelayVector::GetGaussianDelay()
+void DelayVector::GenerateGaussianDelays(double *buffer, size_t count)
 {
-    auto delay = gsl_ran_gaussian(this->rng, this->sigma);
-    delay += this->mu;
+    this->rng.Gaussian(this->drawindex, count, buffer, buffer + count);
+    this->drawindex += count;
 
-    return delay;
+    for(size_t i = 0; i < count; i++)
+        buffer[i] = buffer[i] * this->sigma + this->mu;
 }
 
 
 
-double DelayVector::GetUniformDelay()
+void DelayVector::GenerateUniformDelays(double *buffer, size_t count)
 {
-    auto delay = gsl_ran_flat(this->rng, this->BCET, this->WCET);
+    this->rng.Uniform(this->drawindex, count, buffer);
+    this->drawindex += count;
 
-    return delay;
+    for(size_t i = 0; i < count; i++)
+        buffer[i] = this->BCET * (1.0 - buffer[i]) + this->WCET * buffer[i];
 }
 
 
 
-double DelayVector::GetWCETDelay()
+void DelayVector::GenerateEmpiricalDelays(double *buffer, size_t count)
 {
-    return this->WCET;
+    if(this->aliastable.Size() == 0)    // Missing data
+    {
+        std::fill(buffer, buffer + count, 0.0);
+        return;
+    }
+
+    this->rng.Uniform(this->drawindex, count, buffer);
+    this->drawindex += count;
+
+    for(size_t i = 0; i < count; i++)
+        buffer[i] = this->aliastable.Sample(buffer[i]);
 }
 
 
 
-double DelayVector::GetAverageDelay()
+void DelayVector::GenerateParametricDelays(double *buffer, size_t count)
 {
-    return this->mu;
+    if(this->parametric.GetParameters().empty())    // Missing data
+    {
+        std::fill(buffer, buffer + count, 0.0);
+        return;
+    }
+
+    this->rng.Uniform(this->drawindex, count, buffer);
+    this->drawindex += count;
+
+    for(size_t i = 0; i < count; i++)
+        buffer[i] = this->parametric.Sample(buffer[i]);
 }
 
 
 
-void DelayVector::ReadDelayVector()
+void DelayVector::GenerateConstantDelays(double *buffer, size_t count, double delay)
 {
-    std::ifstream ifs;
-    ifs.open(this->datapath);
+    std::fill(buffer, buffer + count, delay);
+}
 
-    // Initialize min/max with opposite extremes
-    // to approach to the actual values from the file
-    this->WCET = 0.0;
-    this->BCET = std::numeric_limits<decltype(this->BCET)>::max();
+
+
+void DelayVector::ReadDelayVector(const std::string &contents)
+{
+    this->delayvector = this->ReadSamples(contents);
+    this->FindExtremes();
+    this->PostProcessDelayVector();
+    return;
+}
+
+
+
+std::vector<double> DelayVector::ReadSamples(const std::string &contents) const
+{
+    std::vector<double> samples;
+    std::istringstream ifs(contents);
 
     for(std::string line; std::getline(ifs, line); )
     {
@@ -178,92 +652,190 @@ void DelayVector::ReadDelayVector()
                       << line
                       << "\" failed."
                       << "This line will be ignored!\n";
+            continue;
         }
 
-        this->delayvector.emplace_back(time);
+        samples.emplace_back(time);
+    }
+
+    return samples;
+}
+
+
+
+void DelayVector::FindExtremes()
+{
+    // Initialize min/max with opposite extremes
+    // to approach to the actual values from the data
+    this->WCET = 0.0;
+    this->BCET = std::numeric_limits<decltype(this->BCET)>::max();
+
+    for(double time : this->delayvector)
+    {
         if(time > this->WCET)
             this->WCET = time;
         if(time < this->BCET)
             this->BCET = time;
-
     }
+}
 
-    this->PostProcessDelayVector();
 
-    ifs.close();
-    return;
+
+// This is the legacy random number generator of NumPy (numpy.random.seed / RandomState).
+// It is required to reproduce the results of setup/kde.py exactly.
+// MT19937 gets seeded the same way as std::mt19937 (init_genrand).
+
+class LegacyNumPyRandom
+{
+    public:
+        LegacyNumPyRandom(uint32_t seed)
+            : mt(seed), hasgauss(false), gauss(0.0) {};
+
+        // 53 bit resolution uniform random number in [0, 1)
+        double Double()
+        {
+            uint32_t a = this->mt() >> 5;
+            uint32_t b = this->mt() >> 6;
+            return (a * 67108864.0 + b) / 9007199254740992.0;
+        }
+
+        // Polar Box-Muller method. Each second value comes from the previous call.
+        double Gauss()
+        {
+            if(this->hasgauss)
+            {
+                this->hasgauss = false;
+                return this->gauss;
+            }
+
+            double x1, x2, r2;
+            do
+            {
+                x1 = 2.0 * this->Double() - 1.0;
+                x2 = 2.0 * this->Double() - 1.0;
+                r2 = x1 * x1 + x2 * x2;
+            }
+            while(r2 >= 1.0 or r2 == 0.0);
+
+            double f = std::sqrt(-2.0 * std::log(r2) / r2);
+            this->gauss    = f * x1;
+            this->hasgauss = true;
+            return f * x2;
+        }
+
+    private:
+        std::mt19937 mt;
+        bool         hasgauss;
+        double       gauss;
+};
+
+
+
+// Draws one sample per measured delay, like sklearns KernelDensity.sample does
+// after fitting all measured delays as one single data point (see setup/kde.py):
+// First, one uniform number selects the data point (there is only one).
+// Then each delay gets a Gaussian offset with the standard deviation bandwidth.
+// Python's int() truncates the results towards zero.
+std::vector<double> DelayVector::SampleGaussianKDE(const std::vector<double> &samples, double bandwidth, uint32_t seed)
+{
+    LegacyNumPyRandom random(seed);
+    random.Double();
+
+    size_t n = samples.size();
+    std::vector<double> result(n);
+
+    // Drawing the random numbers is sequential by nature.
+    // Applying them can be vectorized by the compiler.
+    for(size_t i = 0; i < n; i++)
+        result[i] = random.Gauss();
+
+    const double *x = samples.data();
+    double       *y = result.data();
+    for(size_t i = 0; i < n; i++)
+        y[i] = std::trunc(x[i] + bandwidth * y[i]);
+
+    return result;
 }
 
 
-void DelayVector::ReadKDEFittedDelayVector()
+
+bool DelayVector::kdecrosscheck = false;
+
+void DelayVector::EnableKDECrossCheck(bool enable)
 {
-    // Check, if there is already cached data
-    //size_t datapathhash = std::hash<std::string>{}(this->datapath);
-    /*
-     * FIXME: This code requires C++17. Currently we are limited to C++14 because of SystemC
-    std::filesystem::path temppath = std::filesystem::temp_directory_path();
-    temppath += std::to_string(datapathhash) + ".txt";
-    * WORKAROUND The following code is an alternative
-    */
-    //std::string cachepath = std::string(secure_getenv("HOME")) + "/.smcdelaycache";
-    //std::string cachefile = std::to_string(datapathhash)       + ".txt";
+    DelayVector::kdecrosscheck = enable;
+}
+
+bool DelayVector::IsKDECrossCheckEnabled()
+{
+    return DelayVector::kdecrosscheck;
+}
 
 
 
-    /* TODO: This is how to create a new directory. Necessary for storing the cached KDE
-    status = mkdir(cachepath.c_str(), S_IRWXU | S_IRG | S_IXG | S_IROTH | S_IXOTH); // Try to create cache directory
-    if(status != 0)
+void DelayVector::ReadKDEFittedDelayVector(const std::string &contents)
+{
+    std::vector<double> samples = this->ReadSamples(contents);
+    if(samples.empty())
     {
-        switch(errno)
-        {
-            case EEXIST: // The directory already exists. This is good.
-                break
-            case EACCES:
-            case ELOOP:
-            case EMLINK:
-            case ENAMETOOLONG:
-            case ENOENT:
-            case ENOSPC:
-            case ENOTDIR:
-            case EROFS:
-            default:
-                std::cerr << "\e[1;33mWARNING:\e[0m Failed to create \""
-                    << temppath << "\" - "
-                    << strerror(errno)
-                    << "\e[1;30m(Trying to proceed anyway)\e[0m\n";
-        }
+        std::cerr << "\e[1;31mERROR:\e[0m No samples in " << this->datapath << " to apply the KDE on!\n";
+        return;
     }
-    */
+
+    // Apply KDE with a bandwidth of 1% of the maximum and the seed used by setup/kde.py
+    double bandwidth = KDEBANDWIDTH * *std::max_element(samples.begin(), samples.end());
+    this->delayvector = DelayVector::SampleGaussianKDE(samples, bandwidth, KDESEED);
+
+    if(DelayVector::kdecrosscheck)
+        this->CrossCheckKDE();
+
+    this->FindExtremes();
+    this->PostProcessDelayVector();
+    return;
+}
+
 
 
-    // Apply KDE
+void DelayVector::CrossCheckKDE() const
+{
+    std::vector<double> reference;
     PythonWrapper &pythonwrapper = PythonWrapper::GetInstance();
-    pythonwrapper.GaussianKDE(&this->delayvector, this->datapath);
+    if(pythonwrapper.GaussianKDE(&reference, this->datapath) != 0)
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m KDE cross-check for " << this->datapath << " failed. Python KDE did not succeed.\n";
+        return;
+    }
 
-    // Initialize min/max with opposite extremes
-    // to approach to the actual values from the file
-    this->WCET = 0.0;
-    this->BCET = std::numeric_limits<decltype(this->BCET)>::max();
+    if(reference.size() != this->delayvector.size())
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m KDE cross-check for " << this->datapath << " failed. "
+                  << "Python returned " << reference.size() << " delays, native KDE " << this->delayvector.size() << "\n";
+        return;
+    }
 
-    for(size_t i = 0; i < this->delayvector.size(); i++)
+    size_t mismatches  = 0;
+    double maxdistance = 0.0;
+    for(size_t i = 0; i < reference.size(); i++)
     {
-        double time;
-        time = this->delayvector[i];
-        if(time > this->WCET)
-            this->WCET = time;
-        if(time < this->BCET)
-            this->BCET = time;
+        double distance = std::fabs(reference[i] - this->delayvector[i]);
+        if(distance > 0.0)
+            mismatches++;
+        maxdistance = std::max(maxdistance, distance);
     }
 
-    this->PostProcessDelayVector();
-    return;
+    if(mismatches == 0)
+        std::cerr << "\e[1;32mKDE cross-check for " << this->datapath << " passed\e[0m\n";
+    else
+        std::cerr << "\e[1;33mWARNING:\e[0m KDE cross-check for " << this->datapath << ": "
+                  << mismatches << " of " << reference.size() << " delays differ "
+                  << "\e[1;30m(maximum difference: " << maxdistance << ")\e[0m\n";
 }
 
 void DelayVector::PostProcessDelayVector()
 {
     // Shuffle delay vector to make sure it is not just a repetition of the measured data
-    std::srand(0);  // Make sure the random number is not depending on call-order
-    std::random_shuffle(this->delayvector.begin(), this->delayvector.end());
+    // The shuffle is the same as in Tools/timing2bin
+    ShuffleDelays(this->delayvector);
 
     // Get further properties from the measured data
     double *data = this->delayvector.data();
@@ -273,5 +845,90 @@ void DelayVector::PostProcessDelayVector()
     return;
 }
 
+// Delay Cache ///////////////
+
+
+bool DelayVector::usecache = true;
+
+void DelayVector::EnableCache(bool enable)
+{
+    DelayVector::usecache = enable;
+}
+
+
+
+// The processed delays depend on the file content, whether a KDE gets applied,
+// and the processing parameters. The distribution used during the simulation does not matter,
+// so the average, WCET, gaussian, uniform and empirical model share the same entry.
+uint64_t DelayVector::CacheKey(const std::string &contents) const
+{
+    uint8_t  kde     = this->UsesKDE() ? 1 : 0;
+    uint32_t version = DelayCache::VERSION;
+
+    uint64_t key;
+    key = DelayCache::Hash(contents.data(), contents.size());
+    key = DelayCache::Hash(&kde,          sizeof(kde),          key);
+    key = DelayCache::Hash(&KDEBANDWIDTH, sizeof(KDEBANDWIDTH), key);
+    key = DelayCache::Hash(&KDESEED,      sizeof(KDESEED),      key);
+    key = DelayCache::Hash(&TIMING_SHUFFLE_SEED, sizeof(TIMING_SHUFFLE_SEED), key);
+    key = DelayCache::Hash(&version,      sizeof(version),      key);
+    return key;
+}
+
+
+
+// The fit depends on the processed delays and the requested family.
+uint64_t DelayVector::FitCacheKey(const std::vector<double> &samples) const
+{
+    const char    tag[]   = "parametric fit";
+    int32_t       family  = this->family;
+    uint32_t      version = DelayCache::FITVERSION;
+
+    uint64_t key;
+    key = DelayCache::Hash(samples.data(), samples.size() * sizeof(double));
+    key = DelayCache::Hash(tag,      sizeof(tag),     key);
+    key = DelayCache::Hash(&family,  sizeof(family),  key);
+    key = DelayCache::Hash(&version, sizeof(version), key);
+    return key;
+}
+
+
+
+bool DelayVector::LoadFromCache(uint64_t key)
+{
+    // The cross-check needs the KDE to be computed
+    if(not DelayVector::usecache or DelayVector::kdecrosscheck)
+        return false;
+
+    CachedDelays entry;
+    if(not GetDelayCache().Load(key, entry))
+        return false;
+
+    this->delayvector = std::move(entry.delays);
+    this->BCET  = entry.BCET;
+    this->WCET  = entry.WCET;
+    this->mu    = entry.mu;
+    this->sigma = entry.sigma;
+
+    std::cerr << "\e[1;30mLoaded " << this->datapath << " from delay cache\e[0m\n";
+    return true;
+}
+
+
+
+void DelayVector::StoreInCache(uint64_t key) const
+{
+    if(not DelayVector::usecache or this->delayvector.empty())
+        return;
+
+    CachedDelays entry;
+    entry.BCET   = this->BCET;
+    entry.WCET   = this->WCET;
+    entry.mu     = this->mu;
+    entry.sigma  = this->sigma;
+    entry.delays = this->delayvector;
+    GetDelayCache().Store(key, entry);
+}
+
 // vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
 
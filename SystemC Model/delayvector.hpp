@@ -6,7 +6,10 @@
 #include <unordered_map>
 #include <systemc.h>
 #include <cstdlib>
-#include <gsl/gsl_rng.h>
+#include <counterrng.hpp>
+#include <aliastable.hpp>
+#include <distributionfit.hpp>
+#include <memory>
 
 enum DISTRIBUTION
 {
@@ -15,10 +18,14 @@ enum DISTRIBUTION
     UNIFORM,
     WCET,
     AVERAGE,
-    GAUSSIAN_KDE
+    GAUSSIAN_KDE,
+    EMPIRICAL,      // Histogram of the measured delays, sampled via an alias table
+    EMPIRICAL_KDE,  // Same, but from the KDE fitted delays
+    PARAMETRIC      // Parametric distribution fitted to the measured delays (see distributionfit.hpp)
 };
 
 class DelayVector;
+class DelayStream;
 typedef std::unordered_map<std::string, DelayVector*> DelayVectorMap;
 
 // Important:
@@ -29,29 +36,81 @@ typedef std::unordered_map<std::string, DelayVector*> DelayVectorMap;
 class DelayVector
 {
     public:
-        DelayVector(const char *path, DISTRIBUTION distribution = DISTRIBUTION::INJECTED, unsigned int offset = 0);
-        DelayVector(std::string path, DISTRIBUTION distribution = DISTRIBUTION::INJECTED, unsigned int offset = 0);
+        DelayVector(const char *path, DISTRIBUTION distribution = DISTRIBUTION::INJECTED, uint64_t offset = 0);
+        DelayVector(std::string path, DISTRIBUTION distribution = DISTRIBUTION::INJECTED, uint64_t offset = 0);
+        ~DelayVector();
 
-        sc_core::sc_time GetDelay();
+        inline sc_core::sc_time GetDelay();
 
         void InitializeData(); // When calling GetDelay the first time,
                                // this method will be called automatically.
                                // Only call this method when you know
                                // before simulation, that you need will
                                // use the data.
+        bool IsInitialized() const;
+        const std::string& GetPath() const;
+
+        // Continues with the offset-th delay, as if the delay vector had been created with this offset.
+        // Delays that are already buffered get dropped.
+        void Seek(uint64_t offset);
+        uint64_t GetPosition() const;   // Offset of the next delay. Seeking there continues with the same delays.
+
+        // The KDE gets computed natively.
+        // With the cross-check enabled, it gets computed by setup/kde.py as well
+        // and both results get compared.
+        static void EnableKDECrossCheck(bool enable=true);
+        static bool IsKDECrossCheckEnabled();
+
+        // Processed delay vectors get cached in ~/.smcdelaycache (enabled by default)
+        static void EnableCache(bool enable=true);
+
+        // Seed of the random number generators of all delay vectors (default: 0)
+        // Each delay vector draws from its own stream, identified by its data path.
+        static void SetSeed(uint64_t seed);
+
+        // Injected delays get streamed from the timing file instead of being loaded completely.
+        // With shuffling enabled, each chunk of the stream gets shuffled (see delaystream.hpp).
+        static void EnableStreaming(bool enable=true);
+        static void EnableStreamShuffle(bool enable=true);
+
+        // Family of the parametric model (default: AUTOMATIC, the best fitting family)
+        // Each delay vector uses the family that was set when it got created.
+        static void SetParametricFamily(FAMILY family);
+        static FAMILY GetParametricFamily();
 
     private:
-        void GenerateOffsetDelays();
+        void SkipOffsetDelays();    // Jumps over the first offset delays in constant time
         
-        double GetInjectedDelay();
-        double GetGaussianDelay();
-        double GetUniformDelay();
-        double GetWCETDelay();
-        double GetAverageDelay();
-
-        void ReadDelayVector();
-        void ReadKDEFittedDelayVector();
+        void RefillTicks();
+        void GenerateInjectedDelays(double *buffer, size_t count);
+        void GenerateGaussianDelays(double *buffer, size_t count);
+        void GenerateUniformDelays( double *buffer, size_t count);
+        void GenerateEmpiricalDelays(double *buffer, size_t count);
+        void GenerateParametricDelays(double *buffer, size_t count);
+        void GenerateConstantDelays(double *buffer, size_t count, double delay);
+
+        bool UsesKDE() const;
+        bool MapTimingFile();   // Returns false if there is no valid binary timing file
+        bool ReadTimingFile();  // Returns false if the file is missing
+        void BuildAliasTable(); // Replaces the delays by their histogram
+        void FitParametricDistribution();   // Replaces the delays by the fitted distribution
+        void ReleaseDelays();
+        double DelayAt(size_t index) const;
+
+        void ReadDelayVector(const std::string &contents);
+        void ReadKDEFittedDelayVector(const std::string &contents);
         void PostProcessDelayVector();
+        std::vector<double> ReadSamples(const std::string &contents) const;
+        void FindExtremes();
+        void CrossCheckKDE() const;
+
+        static std::vector<double> SampleGaussianKDE(const std::vector<double> &samples, double bandwidth, uint32_t seed);
+        static bool kdecrosscheck;
+
+        uint64_t CacheKey(const std::string &contents) const;
+        bool LoadFromCache(uint64_t key);
+        void StoreInCache(uint64_t key) const;
+        static bool usecache;
 
 
 
@@ -59,6 +118,31 @@ class DelayVector
         // In case of GAUSSIAN_KDE these values were pre-processed
         std::vector<double> delayvector;
 
+        // The delays get accessed via these pointers.
+        // They point either into the delayvector, or into a memory mapped binary timing file.
+        // Only one of them is set.
+        const double   *delays;
+        const uint32_t *integerdelays;
+        size_t          delaycount;
+        void           *mapping;    // The binary timing file, nullptr if not mapped
+        size_t          mappingsize;
+        bool            initialized;
+
+        // Streamed injected delays (nullptr if the delays are in memory)
+        std::unique_ptr<DelayStream> stream;
+        static bool streaming;
+        static bool streamshuffle;
+        bool OpenStream();
+
+        // The empirical distributions only keep the distinct delays and their frequencies
+        AliasTable aliastable;
+
+        // The parametric model only keeps the parameters of the fitted distribution
+        ParametricDistribution parametric;
+        FAMILY                 family;
+        static FAMILY          parametricfamily;
+        uint64_t FitCacheKey(const std::vector<double> &samples) const;
+
         // These variables are properties of the measured delay
         double BCET;  // Lowest delay
         double WCET;  // Highest delay
@@ -66,15 +150,39 @@ class DelayVector
         double mu;    // µ / average
 
         // Some variables for accessing the delays
-        unsigned int delayindex; // Next delay in delay vector
-        gsl_rng *rng;   // Random number generator for Normal/Uniform distribution
+        size_t     delayindex;  // Next delay in delay vector
+        uint64_t   drawindex;   // Counter of the next random number
+        CounterRNG rng;         // Random number generator for Normal/Uniform distribution
+        static uint64_t seed;
+
+        // The delays get generated in blocks and stored as SystemC time values.
+        // So GetDelay is just a load from this buffer.
+        static const size_t TICKBUFFERSIZE = 4096;
+        std::vector<sc_dt::uint64> ticks;
+        std::vector<double>        scratch;     // Floating point delays while refilling the ticks
+        size_t                     tickindex;   // Next tick value, ticks.size() when a refill is needed
+        uint64_t                   generated;   // Delays generated since the last seek
 
         std::string  datapath;
         DISTRIBUTION distribution;
 
-        unsigned int offset;
+        uint64_t offset;
 };
 
+
+
+sc_core::sc_time DelayVector::GetDelay()
+{
+    // When this function gets called the first time,
+    // the delay vector gets read from the file and the buffer gets allocated.
+    // This is done here to avoid loading lots of data
+    // that will never be used during the simulation.
+    if(this->tickindex == this->ticks.size())
+        this->RefillTicks();
+
+    return sc_core::sc_time::from_value(this->ticks[this->tickindex++]);
+}
+
 #endif
 // vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
 
@@ -0,0 +1,134 @@
+#include <delayvectorregistry.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <statestream.hpp>
+
+DelayVectorRegistry::DelayVectorRegistry()
+{
+}
+
+
+
+DelayVector* DelayVectorRegistry::Get(const std::string &path, DISTRIBUTION distribution, uint64_t offset)
+{
+    FAMILY family = distribution == DISTRIBUTION::PARAMETRIC ? DelayVector::GetParametricFamily() : FAMILY::AUTOMATIC;
+    std::unique_ptr<DelayVector> &delayvector = this->delayvectors[Key(path, distribution, offset, family)];
+    if(not delayvector)
+        delayvector.reset(new DelayVector(path, distribution, offset));
+    return delayvector.get();
+}
+
+
+
+void DelayVectorRegistry::Preload(const std::vector<DelayVector*> &required, unsigned int threads)
+{
+    // Several actors may share a delay vector
+    std::vector<DelayVector*> pending;
+    for(DelayVector *delayvector : required)
+    {
+        if(delayvector == nullptr or delayvector->IsInitialized())
+            continue;
+        if(std::find(pending.begin(), pending.end(), delayvector) == pending.end())
+            pending.push_back(delayvector);
+    }
+    if(pending.empty())
+        return;
+
+    // The KDE cross-check runs Python, which must not be used by several threads
+    if(threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    if(DelayVector::IsKDECrossCheckEnabled())
+        threads = 1;
+    threads = std::min<size_t>(threads, pending.size());
+
+    typedef std::chrono::steady_clock Clock;
+    std::vector<double>      loadtimes(pending.size()); // in ms
+    std::atomic<size_t>      next(0);
+    std::vector<std::thread> pool;
+    std::vector<std::exception_ptr> errors(threads);    // An exception must not leave a thread
+
+    auto start = Clock::now();
+    for(unsigned int i = 0; i < threads; i++)
+    {
+        pool.emplace_back([&pending, &loadtimes, &next, &errors, i]()
+        {
+            try
+            {
+                for(size_t index = next++; index < pending.size(); index = next++)
+                {
+                    auto begin = Clock::now();
+                    pending[index]->InitializeData();
+                    loadtimes[index] = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+                }
+            }
+            catch(...)
+            {
+                errors[i] = std::current_exception();
+                next      = pending.size();     // The other threads stop after their current delay vector
+            }
+        });
+    }
+    for(auto &thread : pool)
+        thread.join();
+
+    for(const std::exception_ptr &error : errors)
+    {
+        if(error)
+            std::rethrow_exception(error);
+    }
+    double totaltime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::cerr << "\e[1;34mLoaded " << pending.size() << " delay vectors in "
+              << std::fixed << std::setprecision(1) << totaltime << " ms \e[1;30m(" << threads << " threads)\e[0m\n";
+    for(size_t index = 0; index < pending.size(); index++)
+        std::cerr << "\e[1;30m" << std::setw(10) << loadtimes[index] << " ms  " << pending[index]->GetPath() << "\e[0m\n";
+    std::cerr << std::defaultfloat;
+}
+
+void DelayVectorRegistry::Seek(uint64_t offset)
+{
+    for(auto &delayvector : this->delayvectors)
+        delayvector.second->Seek(offset);
+}
+
+
+
+// The delay vectors are identified by their key, so the order they got created in does not matter
+void DelayVectorRegistry::SaveState(std::ostream &state) const
+{
+    state::Write<uint64_t>(state, this->delayvectors.size());
+    for(const auto &delayvector : this->delayvectors)
+    {
+        state::WriteString(state, std::get<0>(delayvector.first));
+        state::Write<int32_t>(state,  std::get<1>(delayvector.first));
+        state::Write<uint64_t>(state, std::get<2>(delayvector.first));
+        state::Write<int32_t>(state,  std::get<3>(delayvector.first));
+        state::Write<uint64_t>(state, delayvector.second->GetPosition());
+    }
+}
+
+void DelayVectorRegistry::LoadState(std::istream &state)
+{
+    uint64_t count = state::Read<uint64_t>(state);
+    for(uint64_t i = 0; i < count; i++)
+    {
+        std::string  path         = state::ReadString(state);
+        DISTRIBUTION distribution = static_cast<DISTRIBUTION>(state::Read<int32_t>(state));
+        uint64_t     offset       = state::Read<uint64_t>(state);
+        FAMILY       family       = static_cast<FAMILY>(state::Read<int32_t>(state));
+        uint64_t     position     = state::Read<uint64_t>(state);
+
+        auto delayvector = this->delayvectors.find(Key(path, distribution, offset, family));
+        if(delayvector == this->delayvectors.end())
+            throw std::runtime_error("Checkpoint contains the unknown delay vector " + path);
+        delayvector->second->Seek(position);
+    }
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,48 @@
+#ifndef DELAYVECTORREGISTRY_HPP
+#define DELAYVECTORREGISTRY_HPP
+
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <delayvector.hpp>
+
+// Owns all delay vectors of a simulation.
+//
+// Delay vectors with the same path, distribution and offset get shared.
+// Parametric delay vectors get only shared when they use the same family.
+// Before the simulation starts, the delay vectors of the mapped actors can be loaded concurrently.
+// Otherwise each delay vector gets loaded when its first delay is needed, in the middle of the simulation.
+
+class DelayVectorRegistry
+{
+    public:
+        DelayVectorRegistry();
+
+        DelayVector* Get(const std::string &path, DISTRIBUTION distribution, uint64_t offset = 0);
+
+        // Loads and processes the delay vectors on a pool of threads.
+        // Already loaded delay vectors and nullptr get ignored.
+        // threads = 0 uses one thread per core.
+        // If loading a delay vector fails, the first exception gets rethrown after all threads have finished.
+        void Preload(const std::vector<DelayVector*> &required, unsigned int threads = 0);
+
+        // Moves all delay vectors to the same offset (see DelayVector::Seek).
+        // Afterwards, Get still finds them by the offset they were created with.
+        void Seek(uint64_t offset);
+
+        // Positions of all delay vectors for checkpoints.
+        // Loading seeks each delay vector to its saved position.
+        void SaveState(std::ostream &state) const;
+        void LoadState(std::istream &state);
+
+    private:
+        typedef std::tuple<std::string, DISTRIBUTION, uint64_t, FAMILY> Key;
+        std::map<Key, std::unique_ptr<DelayVector>> delayvectors;
+};
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,529 @@
+#include <distributionfit.hpp>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <thread>
+#include <gsl/gsl_cdf.h>
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_sf_psi.h>
+
+// The measured delays are integer cycle counts with only a few hundred distinct values.
+// All fits work on the distinct values and their frequencies instead of the raw samples.
+struct WeightedSamples
+{
+    std::vector<double> values; // sorted
+    std::vector<double> counts;
+    double              n;
+};
+
+// Lower bound for the standard deviation of the mixture components, in clock cycles.
+// Without it, a component can collapse onto a single cycle count.
+const double MINIMUMSIGMA   = 0.5;
+const int    MAXITERATIONS  = 500;
+
+
+
+// By default, GSL aborts the process on errors like a failed convergence.
+// The fits and the sampling check the results instead.
+static void DisableGSLErrorHandler()
+{
+    static const bool disabled = (gsl_set_error_handler_off(), true);
+    (void)disabled;
+}
+
+
+
+ParametricDistribution::ParametricDistribution()
+    : family(FAMILY::AUTOMATIC)
+{
+}
+
+// The gamma distribution has no closed-form inverse CDF, and gsl_cdf_gamma_Pinv is too slow to call for each delay.
+// Entry i of the table is the quantile of i / QUANTILES. The tails get computed exactly, because the quantiles
+// change too fast there for a linear interpolation.
+ParametricDistribution::ParametricDistribution(FAMILY family, const std::vector<double> &parameters)
+    : family(family)
+    , parameters(parameters)
+{
+    DisableGSLErrorHandler();
+    if(this->family != FAMILY::GAMMA or this->parameters.size() < 2)
+        return;
+
+    std::shared_ptr<std::vector<double>> quantiles(new std::vector<double>(QUANTILES));
+    for(size_t i = 1; i < QUANTILES; i++)
+    {
+        (*quantiles)[i] = gsl_cdf_gamma_Pinv(static_cast<double>(i) / QUANTILES, this->parameters[0], this->parameters[1]);
+        if(not std::isfinite((*quantiles)[i]))
+            return; // Sample falls back to gsl_cdf_gamma_Pinv
+    }
+    this->quantiles = quantiles;
+}
+
+
+
+double ParametricDistribution::CDF(double x) const
+{
+    const std::vector<double> &p = this->parameters;
+    switch(this->family)
+    {
+        case FAMILY::LOGNORMAL:
+            return x > 0.0 ? gsl_cdf_lognormal_P(x, p[0], p[1]) : 0.0;
+
+        case FAMILY::GAMMA:
+            return x > 0.0 ? gsl_cdf_gamma_P(x, p[0], p[1]) : 0.0;
+
+        case FAMILY::WEIBULL:
+            return x > 0.0 ? gsl_cdf_weibull_P(x, p[0], p[1]) : 0.0;
+
+        case FAMILY::SHIFTEDEXPONENTIAL:
+            if(not (p[1] > 0.0))    // Point mass at the shift
+                return x >= p[0] ? 1.0 : 0.0;
+            return x > p[0] ? gsl_cdf_exponential_P(x - p[0], p[1]) : 0.0;
+
+        case FAMILY::GAUSSIANMIXTURE:
+            return        p[0]  * gsl_cdf_gaussian_P(x - p[1], p[2])
+                 + (1.0 - p[0]) * gsl_cdf_gaussian_P(x - p[3], p[4]);
+
+        default:
+            return 0.0;
+    }
+}
+
+
+
+double ParametricDistribution::Sample(double u) const
+{
+    const std::vector<double> &p = this->parameters;
+    switch(this->family)
+    {
+        case FAMILY::LOGNORMAL:
+            return std::exp(p[0] + p[1] * gsl_cdf_ugaussian_Pinv(u));
+
+        case FAMILY::GAMMA:
+        {
+            double position = u * QUANTILES;
+            size_t index    = static_cast<size_t>(position);
+            if(this->quantiles and index > 0 and index + 1 < QUANTILES)
+            {
+                const std::vector<double> &q = *this->quantiles;
+                return q[index] + (position - index) * (q[index + 1] - q[index]);
+            }
+
+            double x = gsl_cdf_gamma_Pinv(u, p[0], p[1]);
+            if(not std::isfinite(x) and this->quantiles)
+                x = index == 0 ? (*this->quantiles)[1] : this->quantiles->back();
+            return x;
+        }
+
+        case FAMILY::WEIBULL:
+            return p[0] * std::pow(-std::log1p(-u), 1.0 / p[1]);
+
+        case FAMILY::SHIFTEDEXPONENTIAL:
+            return p[0] - p[1] * std::log1p(-u);
+
+        case FAMILY::GAUSSIANMIXTURE:
+            // u selects the component. Rescaled to [0, 1) again, it gets mapped by the component's inverse CDF.
+            if(u < p[0])
+                return p[1] + p[2] * gsl_cdf_ugaussian_Pinv(u / p[0]);
+            else
+                return p[3] + p[4] * gsl_cdf_ugaussian_Pinv((u - p[0]) / (1.0 - p[0]));
+
+        default:
+            return 0.0;
+    }
+}
+
+
+
+FAMILY ParametricDistribution::GetFamily() const
+{
+    return this->family;
+}
+
+const std::vector<double>& ParametricDistribution::GetParameters() const
+{
+    return this->parameters;
+}
+
+
+
+const char* ParametricDistribution::FamilyName(FAMILY family)
+{
+    switch(family)
+    {
+        case FAMILY::AUTOMATIC:          return "automatic";
+        case FAMILY::LOGNORMAL:          return "lognormal";
+        case FAMILY::GAMMA:              return "gamma";
+        case FAMILY::WEIBULL:            return "weibull";
+        case FAMILY::SHIFTEDEXPONENTIAL: return "shifted exponential";
+        case FAMILY::GAUSSIANMIXTURE:    return "gaussian mixture";
+    }
+    return "unknown";
+}
+
+
+
+std::string ParametricDistribution::ToString() const
+{
+    static const char *names[][5] = {
+        {},
+        {"zeta",   "sigma"},
+        {"shape",  "scale"},
+        {"scale",  "shape"},
+        {"shift",  "mean"},
+        {"weight", "mu1", "sigma1", "mu2", "sigma2"}
+    };
+
+    std::ostringstream string;
+    string << ParametricDistribution::FamilyName(this->family) << " (";
+    for(size_t i = 0; i < this->parameters.size() and i < 5; i++)
+    {
+        if(i > 0)
+            string << ", ";
+        string << names[this->family][i] << " = " << this->parameters[i];
+    }
+    string << ")";
+    return string.str();
+}
+
+
+
+// Fitting //////////////////////
+
+
+static FitResult InvalidFit(FAMILY family)
+{
+    return FitResult{ParametricDistribution(family, {}), 1.0};
+}
+
+
+
+// Kolmogorov-Smirnov distance between the fitted CDF and the empirical CDF.
+// The empirical CDF jumps at each distinct value, so both sides of the step get compared.
+static double KolmogorovSmirnovDistance(const ParametricDistribution &distribution, const WeightedSamples &samples)
+{
+    double distance   = 0.0;
+    double cumulative = 0.0;
+    for(size_t i = 0; i < samples.values.size(); i++)
+    {
+        double F      = distribution.CDF(samples.values[i]);
+        if(not std::isfinite(F))
+            return 1.0;     // GSL failed for these parameters
+        double before = cumulative / samples.n;
+        cumulative   += samples.counts[i];
+        double after  = cumulative / samples.n;
+
+        distance = std::max(distance, std::max(std::fabs(F - before), std::fabs(F - after)));
+    }
+    return distance;
+}
+
+
+
+static double Mean(const WeightedSamples &samples)
+{
+    double sum = 0.0;
+    for(size_t i = 0; i < samples.values.size(); i++)
+        sum += samples.counts[i] * samples.values[i];
+    return sum / samples.n;
+}
+
+static double MeanOfLogs(const WeightedSamples &samples)
+{
+    double sum = 0.0;
+    for(size_t i = 0; i < samples.values.size(); i++)
+        sum += samples.counts[i] * std::log(samples.values[i]);
+    return sum / samples.n;
+}
+
+
+
+static FitResult FitLognormal(const WeightedSamples &samples)
+{
+    if(samples.values.front() <= 0.0)
+        return InvalidFit(FAMILY::LOGNORMAL);
+
+    double zeta     = MeanOfLogs(samples);
+    double variance = 0.0;
+    for(size_t i = 0; i < samples.values.size(); i++)
+    {
+        double d  = std::log(samples.values[i]) - zeta;
+        variance += samples.counts[i] * d * d;
+    }
+    double sigma = std::sqrt(variance / samples.n);
+    if(not (sigma > 0.0))
+        return InvalidFit(FAMILY::LOGNORMAL);
+
+    ParametricDistribution distribution(FAMILY::LOGNORMAL, {zeta, sigma});
+    return FitResult{distribution, KolmogorovSmirnovDistance(distribution, samples)};
+}
+
+
+
+// The maximum likelihood shape k solves log(k) - psi(k) = log(mean) - mean(log(x)).
+// Newton's method starts at the approximation by Minka.
+static FitResult FitGamma(const WeightedSamples &samples)
+{
+    if(samples.values.front() <= 0.0)
+        return InvalidFit(FAMILY::GAMMA);
+
+    double mean = Mean(samples);
+    double s    = std::log(mean) - MeanOfLogs(samples);
+    if(not (s > 0.0))
+        return InvalidFit(FAMILY::GAMMA);
+
+    double shape = (3.0 - s + std::sqrt((s - 3.0) * (s - 3.0) + 24.0 * s)) / (12.0 * s);
+    for(int iteration = 0; iteration < MAXITERATIONS; iteration++)
+    {
+        double f     = std::log(shape) - gsl_sf_psi(shape) - s;
+        double slope = 1.0 / shape - gsl_sf_psi_1(shape);
+        double next  = shape - f / slope;
+        if(next <= 0.0)
+            next = shape / 2.0;
+
+        bool converged = std::fabs(next - shape) < 1e-10 * shape;
+        shape = next;
+        if(converged)
+            break;
+    }
+
+    if(not (std::isfinite(shape) and shape > 0.0))
+        return InvalidFit(FAMILY::GAMMA);
+
+    ParametricDistribution distribution(FAMILY::GAMMA, {shape, mean / shape});
+    return FitResult{distribution, KolmogorovSmirnovDistance(distribution, samples)};
+}
+
+
+
+// The maximum likelihood shape k solves sum(x^k log(x)) / sum(x^k) - 1/k - mean(log(x)) = 0.
+// The samples get normalized by their maximum, so x^k can not overflow for large shapes.
+static FitResult FitWeibull(const WeightedSamples &samples)
+{
+    if(samples.values.front() <= 0.0 or samples.values.front() == samples.values.back())
+        return InvalidFit(FAMILY::WEIBULL);
+
+    double maximum = samples.values.back();
+    size_t m       = samples.values.size();
+
+    std::vector<double> logs(m);
+    double meanlog = 0.0;
+    for(size_t i = 0; i < m; i++)
+    {
+        logs[i]  = std::log(samples.values[i] / maximum);
+        meanlog += samples.counts[i] * logs[i];
+    }
+    meanlog /= samples.n;
+
+    double variance = 0.0;
+    for(size_t i = 0; i < m; i++)
+        variance += samples.counts[i] * (logs[i] - meanlog) * (logs[i] - meanlog);
+    double shape = 1.2 / std::sqrt(variance / samples.n);
+
+    double B = 0.0;
+    for(int iteration = 0; iteration < MAXITERATIONS; iteration++)
+    {
+        double A = 0.0, C = 0.0;
+        B = 0.0;
+        for(size_t i = 0; i < m; i++)
+        {
+            double power = samples.counts[i] * std::exp(shape * logs[i]);
+            A += power * logs[i];
+            B += power;
+            C += power * logs[i] * logs[i];
+        }
+
+        double f     = A / B - 1.0 / shape - meanlog;
+        double slope = (C * B - A * A) / (B * B) + 1.0 / (shape * shape);
+        double next  = shape - f / slope;
+        if(next <= 0.0)
+            next = shape / 2.0;
+
+        bool converged = std::fabs(next - shape) < 1e-10 * shape;
+        shape = next;
+        if(converged)
+            break;
+    }
+
+    B = 0.0;
+    for(size_t i = 0; i < m; i++)
+        B += samples.counts[i] * std::exp(shape * logs[i]);
+    double scale = maximum * std::pow(B / samples.n, 1.0 / shape);
+
+    ParametricDistribution distribution(FAMILY::WEIBULL, {scale, shape});
+    return FitResult{distribution, KolmogorovSmirnovDistance(distribution, samples)};
+}
+
+
+
+static FitResult FitShiftedExponential(const WeightedSamples &samples)
+{
+    double shift = samples.values.front();
+    double mean  = Mean(samples) - shift;
+    if(not (mean > 0.0))
+        return InvalidFit(FAMILY::SHIFTEDEXPONENTIAL);
+
+    ParametricDistribution distribution(FAMILY::SHIFTEDEXPONENTIAL, {shift, mean});
+    return FitResult{distribution, KolmogorovSmirnovDistance(distribution, samples)};
+}
+
+
+
+// Expectation maximization for two gaussian components.
+// The components start at the lower and upper quartile.
+static FitResult FitGaussianMixture(const WeightedSamples &samples)
+{
+    size_t m = samples.values.size();
+    if(m < 2)
+        return InvalidFit(FAMILY::GAUSSIANMIXTURE);
+
+    auto Quantile = [&samples](double q)
+    {
+        double cumulative = 0.0;
+        for(size_t i = 0; i < samples.values.size(); i++)
+        {
+            cumulative += samples.counts[i];
+            if(cumulative >= q * samples.n)
+                return samples.values[i];
+        }
+        return samples.values.back();
+    };
+
+    double mean     = Mean(samples);
+    double variance = 0.0;
+    for(size_t i = 0; i < m; i++)
+        variance += samples.counts[i] * (samples.values[i] - mean) * (samples.values[i] - mean);
+    double sigma = std::max(std::sqrt(variance / samples.n), MINIMUMSIGMA);
+
+    double w  = 0.5;
+    double mu1 = Quantile(0.25), sigma1 = sigma;
+    double mu2 = Quantile(0.75), sigma2 = sigma;
+
+    std::vector<double> responsibility(m);
+    double previousloglikelihood = -INFINITY;
+    for(int iteration = 0; iteration < MAXITERATIONS; iteration++)
+    {
+        // E-step: Probability that a value belongs to the first component
+        double loglikelihood = 0.0;
+        for(size_t i = 0; i < m; i++)
+        {
+            double z1 = (samples.values[i] - mu1) / sigma1;
+            double z2 = (samples.values[i] - mu2) / sigma2;
+            double p1 =        w  * std::exp(-0.5 * z1 * z1) / sigma1;
+            double p2 = (1.0 - w) * std::exp(-0.5 * z2 * z2) / sigma2;
+            double p  = p1 + p2;
+
+            responsibility[i] = p > 0.0 ? p1 / p : (std::fabs(z1) < std::fabs(z2) ? 1.0 : 0.0);
+            loglikelihood    += samples.counts[i] * std::log(p > 0.0 ? p : 1e-300);
+        }
+
+        // M-step
+        double n1 = 0.0, sum1 = 0.0, sum2 = 0.0;
+        for(size_t i = 0; i < m; i++)
+        {
+            double c1 = samples.counts[i] * responsibility[i];
+            double c2 = samples.counts[i] - c1;
+            n1   += c1;
+            sum1 += c1 * samples.values[i];
+            sum2 += c2 * samples.values[i];
+        }
+        double n2 = samples.n - n1;
+        if(n1 <= 0.0 or n2 <= 0.0)
+            return InvalidFit(FAMILY::GAUSSIANMIXTURE); // One component vanished - a single gaussian fits better
+
+        mu1 = sum1 / n1;
+        mu2 = sum2 / n2;
+
+        double squares1 = 0.0, squares2 = 0.0;
+        for(size_t i = 0; i < m; i++)
+        {
+            double c1 = samples.counts[i] * responsibility[i];
+            double c2 = samples.counts[i] - c1;
+            squares1 += c1 * (samples.values[i] - mu1) * (samples.values[i] - mu1);
+            squares2 += c2 * (samples.values[i] - mu2) * (samples.values[i] - mu2);
+        }
+        sigma1 = std::max(std::sqrt(squares1 / n1), MINIMUMSIGMA);
+        sigma2 = std::max(std::sqrt(squares2 / n2), MINIMUMSIGMA);
+        w      = n1 / samples.n;
+
+        if(std::fabs(loglikelihood - previousloglikelihood) < 1e-10 * std::fabs(loglikelihood))
+            break;
+        previousloglikelihood = loglikelihood;
+    }
+
+    ParametricDistribution distribution(FAMILY::GAUSSIANMIXTURE, {w, mu1, sigma1, mu2, sigma2});
+    return FitResult{distribution, KolmogorovSmirnovDistance(distribution, samples)};
+}
+
+
+
+static FitResult Fit(const WeightedSamples &samples, FAMILY family)
+{
+    switch(family)
+    {
+        case FAMILY::LOGNORMAL:          return FitLognormal(samples);
+        case FAMILY::GAMMA:              return FitGamma(samples);
+        case FAMILY::WEIBULL:            return FitWeibull(samples);
+        case FAMILY::SHIFTEDEXPONENTIAL: return FitShiftedExponential(samples);
+        case FAMILY::GAUSSIANMIXTURE:    return FitGaussianMixture(samples);
+        default:                         return InvalidFit(family);
+    }
+}
+
+
+
+FitResult FitDistribution(const std::vector<double> &samples, FAMILY family, std::vector<FitResult> *candidates)
+{
+    if(samples.empty())
+        return InvalidFit(family);
+
+    DisableGSLErrorHandler();
+
+    // Condense the samples into their distinct values
+    std::vector<double> sorted(samples);
+    std::sort(sorted.begin(), sorted.end());
+
+    WeightedSamples weighted;
+    weighted.n = sorted.size();
+    for(double value : sorted)
+    {
+        if(weighted.values.empty() or weighted.values.back() != value)
+        {
+            weighted.values.push_back(value);
+            weighted.counts.push_back(0.0);
+        }
+        weighted.counts.back() += 1.0;
+    }
+
+    // A delay that was always measured with the same value can not be fitted by any family.
+    // It becomes a point mass: A shifted exponential distribution with a mean of 0 always samples the shift.
+    if(weighted.values.size() == 1)
+    {
+        FitResult constant{ParametricDistribution(FAMILY::SHIFTEDEXPONENTIAL, {weighted.values.front(), 0.0}), 0.0};
+        if(candidates != nullptr)
+            *candidates = {constant};
+        return constant;
+    }
+
+    std::vector<FAMILY> families;
+    if(family == FAMILY::AUTOMATIC)
+        families = {FAMILY::LOGNORMAL, FAMILY::GAMMA, FAMILY::WEIBULL, FAMILY::SHIFTEDEXPONENTIAL, FAMILY::GAUSSIANMIXTURE};
+    else
+        families = {family};
+
+    // The fits are independent. Each thread writes only its own result.
+    std::vector<FitResult>   results(families.size(), InvalidFit(family));
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < families.size(); i++)
+        threads.emplace_back([&results, &weighted, &families, i]() { results[i] = Fit(weighted, families[i]); });
+    for(auto &thread : threads)
+        thread.join();
+
+    if(candidates != nullptr)
+        *candidates = results;
+
+    return *std::min_element(results.begin(), results.end(),
+            [](const FitResult &a, const FitResult &b) { return a.ksdistance < b.ksdistance; });
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
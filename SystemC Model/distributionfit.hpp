@@ -0,0 +1,72 @@
+#ifndef DISTRIBUTIONFIT_HPP
+#define DISTRIBUTIONFIT_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Parametric models for measured delays
+//
+// Each family gets fitted by maximum likelihood to the measured delays.
+// The goodness of fit is the Kolmogorov-Smirnov distance between the fitted
+// and the empirical distribution function. The smallest distance wins.
+//
+// Family               Parameters
+// LOGNORMAL            zeta, sigma         (mean and standard deviation of log(x))
+// GAMMA                shape, scale
+// WEIBULL              scale, shape
+// SHIFTEDEXPONENTIAL   shift, mean         (mean of x - shift, 0 for a constant delay)
+// GAUSSIANMIXTURE      weight, mu1, sigma1, mu2, sigma2   (weight of the first component)
+
+enum FAMILY
+{
+    AUTOMATIC,      // Fit all families and select the best one
+    LOGNORMAL,
+    GAMMA,
+    WEIBULL,
+    SHIFTEDEXPONENTIAL,
+    GAUSSIANMIXTURE
+};
+
+class ParametricDistribution
+{
+    public:
+        ParametricDistribution();
+        ParametricDistribution(FAMILY family, const std::vector<double> &parameters);
+
+        double CDF(double x) const;
+
+        // Maps a uniform random number u in [0, 1) to a sample of the distribution.
+        // Except for the mixture, this is the inverse of the CDF.
+        // The gamma quantiles get interpolated in a table that is computed once by the constructor.
+        double Sample(double u) const;
+
+        FAMILY GetFamily() const;
+        const std::vector<double>& GetParameters() const;
+        std::string ToString() const;
+
+        static const char* FamilyName(FAMILY family);
+
+    private:
+        static const size_t QUANTILES = 4096;   // Intervals of the gamma quantile table
+
+        FAMILY              family;
+        std::vector<double> parameters;
+        std::shared_ptr<const std::vector<double>> quantiles;   // Shared by the copies
+};
+
+struct FitResult
+{
+    ParametricDistribution distribution;
+    double ksdistance;  // 1.0 if the family can not be fitted to the samples
+};
+
+// Fits the family to the samples. With AUTOMATIC, all families get fitted in parallel,
+// and the one with the lowest Kolmogorov-Smirnov distance is returned.
+// Samples with only one distinct value result in a point mass at that value for any family.
+// When candidates is not nullptr, it receives the results of all fitted families.
+FitResult FitDistribution(const std::vector<double> &samples, FAMILY family = FAMILY::AUTOMATIC,
+                          std::vector<FitResult> *candidates = nullptr);
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,218 @@
+#include <experimentsweep.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <fcntl.h>
+#include <glob.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <interruption.hpp>
+
+ExperimentSweep::ExperimentSweep(const std::vector<std::string> &patterns)
+{
+    std::vector<std::string> paths;
+    for(std::string pattern : patterns)
+    {
+        if(pattern.find('/') == std::string::npos)
+            pattern = "./experiments/" + pattern;
+        if(pattern.size() < 4 or pattern.compare(pattern.size() - 4, 4, ".xml") != 0)
+            pattern += ".xml";
+
+        glob_t matches;
+        if(glob(pattern.c_str(), 0, nullptr, &matches) != 0)
+        {
+            std::cerr << "\e[1;33mWARNING:\e[0m No experiment matches " << pattern << "\n";
+            globfree(&matches);
+            continue;
+        }
+        for(size_t i = 0; i < matches.gl_pathc; i++)
+        {
+            std::string path = matches.gl_pathv[i];
+            if(path.compare(0, 2, "./") == 0)
+                path.erase(0, 2);
+            paths.push_back(path);
+        }
+        globfree(&matches);
+    }
+
+    // Overlapping patterns select an experiment only once
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    for(const std::string &path : paths)
+    {
+        SweepExperiment experiment;
+        size_t begin = path.rfind('/');
+        begin = begin == std::string::npos ? 0 : begin + 1;
+        experiment.path    = path;
+        experiment.name    = path.substr(begin, path.size() - 4 - begin);
+        experiment.pid     = 0;
+        experiment.seconds = 0.0;
+        experiment.status  = -1;
+        this->experiments.push_back(experiment);
+    }
+}
+
+
+
+const std::vector<SweepExperiment>& ExperimentSweep::GetExperiments() const
+{
+    return this->experiments;
+}
+
+
+
+size_t ExperimentSweep::Run(unsigned int limit, const std::string &logdirectory,
+                            const std::function<int(const SweepExperiment&)> &run)
+{
+    typedef std::chrono::steady_clock Clock;
+    std::map<pid_t, std::pair<size_t, Clock::time_point>> running;  // index and start time of each process
+
+    limit = std::max(limit, 1u);
+    size_t next   = 0;
+    size_t failed = 0;
+    pid_t  parent = getpid();
+
+    // After an interrupt signal, no more experiments get started.
+    // The experiments run in their own process group, so the signal gets forwarded to the running ones.
+    // They stop after their current iteration.
+    bool forwarded = false;
+    while((next < this->experiments.size() and not Interruption::IsRequested()) or not running.empty())
+    {
+        // Start as many experiments as allowed
+        while(next < this->experiments.size() and running.size() < limit and not Interruption::IsRequested())
+        {
+            SweepExperiment &experiment = this->experiments[next];
+            std::string      logpath    = logdirectory + "/" + experiment.name + ".log";
+
+            std::cout.flush();
+            std::cerr.flush();
+            experiment.pid = fork();
+            if(experiment.pid == 0)
+            {
+                prctl(PR_SET_PDEATHSIG, SIGTERM);
+                if(getppid() != parent)
+                    _exit(EXIT_FAILURE);
+                setpgid(0, 0);
+
+                int log = open(logpath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                if(log >= 0)
+                {
+                    dup2(log, STDERR_FILENO);
+                    close(log);
+                }
+
+                int status = EXIT_FAILURE;
+                try
+                {
+                    status = run(experiment);
+                }
+                catch(const std::exception &e)
+                {
+                    std::cerr << "\e[1;31mERROR:\e[0m " << e.what() << "\n";
+                }
+                std::cout.flush();
+                _exit(status);
+            }
+
+            if(experiment.pid < 0)
+            {
+                std::cerr << "\e[1;31mERROR:\e[0m Starting process for experiment " << experiment.name
+                          << " failed - " << strerror(errno) << "\n";
+                experiment.status = -1;
+                failed++;
+                next++;
+                continue;
+            }
+
+            setpgid(experiment.pid, experiment.pid);  // Like in the child, whichever comes first
+
+            std::cerr << "\e[1;30mStarted " << experiment.name << " (" << next + 1 << "/" << this->experiments.size() << ")\e[0m\n";
+            running[experiment.pid] = std::make_pair(next, Clock::now());
+            next++;
+        }
+
+        if(running.empty())
+            continue;
+
+        if(Interruption::IsRequested() and not forwarded)
+        {
+            for(const auto &process : running)
+                kill(process.first, Interruption::GetSignal());
+            forwarded = true;
+        }
+
+        // Wait for any experiment to finish.
+        // An interrupt signal lets waitpid fail with EINTR, so it gets forwarded in the next round.
+        int   status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if(pid < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            std::cerr << "\e[1;31mERROR:\e[0m Waiting for experiments failed - " << strerror(errno) << "\n";
+            throw std::runtime_error("Waiting for experiments failed!");
+        }
+
+        auto process = running.find(pid);
+        if(process == running.end())
+            continue;
+
+        SweepExperiment &experiment = this->experiments[process->second.first];
+        experiment.seconds = std::chrono::duration<double>(Clock::now() - process->second.second).count();
+        experiment.status  = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        running.erase(process);
+
+        if(experiment.status == EXIT_SUCCESS)
+        {
+            std::cerr << "\e[1;34mFinished " << experiment.name << " after "
+                      << std::round(experiment.seconds * 10.0) / 10.0 << "s\e[0m\n";
+        }
+        else if(Interruption::IsRequested() and experiment.status == Interruption::GetExitStatus())
+        {
+            std::cerr << "\e[1;33mWARNING:\e[0m Experiment " << experiment.name << " got interrupted after "
+                      << std::round(experiment.seconds * 10.0) / 10.0 << "s \e[1;30m(Partial results)\e[0m\n";
+            failed++;
+        }
+        else
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m Experiment " << experiment.name << " failed";
+            if(WIFSIGNALED(status))
+                std::cerr << " \e[1;30m(" << strsignal(WTERMSIG(status)) << ")\e[0m";
+            std::cerr << " - see " << logdirectory << "/" << experiment.name << ".log\n";
+            failed++;
+        }
+    }
+
+    // Experiments that did not start because of an interrupt signal did not finish either
+    failed += this->experiments.size() - next;
+    return failed;
+}
+
+
+
+void ExperimentSweep::WriteTimings(std::ostream &stream) const
+{
+    stream << std::setprecision(6);
+    stream << "[\n";
+    for(size_t i = 0; i < this->experiments.size(); i++)
+    {
+        const SweepExperiment &experiment = this->experiments[i];
+        stream << "  { \"experiment\": \"" << experiment.name << "\", "
+               << "\"status\": "  << experiment.status << ", "
+               << "\"seconds\": " << experiment.seconds << " }"
+               << (i + 1 < this->experiments.size() ? ",\n" : "\n");
+    }
+    stream << "]\n";
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,51 @@
+#ifndef EXPERIMENTSWEEP_HPP
+#define EXPERIMENTSWEEP_HPP
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+// Runs many experiments, each in its own forked process.
+//
+// The process that creates the sweep loads everything the experiments share (applications, delay vectors)
+// before calling Run, so the forked processes get it copy-on-write instead of loading it again.
+// Each process starts with an unused SystemC kernel and elaborates its experiment from scratch.
+
+struct SweepExperiment
+{
+    std::string path;       // of the XML file
+    std::string name;       // file name without directory and .xml
+    pid_t       pid;
+    double      seconds;    // Wall clock time from fork to exit
+    int         status;     // Exit code, -1 if the process got killed
+};
+
+class ExperimentSweep
+{
+    public:
+        // Each pattern is a glob pattern of XML files.
+        // Patterns without a directory refer to ./experiments, and .xml gets appended when missing.
+        // So "mdpi-Sobel2-*" selects ./experiments/mdpi-Sobel2-*.xml
+        ExperimentSweep(const std::vector<std::string> &patterns);
+
+        const std::vector<SweepExperiment>& GetExperiments() const;
+
+        // Calls run for each experiment in a forked process, with at most limit processes at the same time.
+        // The return value of run is the exit code of the process.
+        // The error output of each process gets written into <logdirectory>/<name>.log.
+        // Returns the number of failed experiments.
+        // After an interrupt signal (see interruption.hpp), no more experiments get started.
+        size_t Run(unsigned int limit, const std::string &logdirectory,
+                   const std::function<int(const SweepExperiment&)> &run);
+
+        // Exit status and wall clock time of each experiment as JSON
+        void WriteTimings(std::ostream &stream) const;
+
+    private:
+        std::vector<SweepExperiment> experiments;
+};
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -4,13 +4,93 @@
 #include <hardware/axiinterconnect.hpp>
 #include <hardware/tile.hpp>
 #include <hardware/memory.hpp>
+#include <statestream.hpp>
 
-AXIInterconnect::AXIInterconnect(const char* name)
+AXIInterconnect::AXIInterconnect(const char* name, ARBITRATIONPOLICY policy, sc_core::sc_time slot)
     : Interconnect(name)
     , contender(0)
+    , policy(policy)
+    , slot(slot)
+    , owner(-1)
+    , lastgranted(-1)
     , readpenalties( { -1,  0,  5,  3, 11, 19, 27, 35}) // -1: there is at least 1 PE accessing the bus
     , writepenalties({ -1,  0,  0,  7,  2,  7, 12, 17}) // so [0] is invalid and therefore [0] = -1
+    , transactions(0)
+    , sleepingpollers(0)
+    , fastforwardedpolls(0)
 {
+    if(this->policy == ARBITRATIONPOLICY::TDMA and this->slot == sc_core::SC_ZERO_TIME)
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m TDMA arbitration requires a slot length. Using contention penalties only instead.\n";
+        this->policy = ARBITRATIONPOLICY::NONE;
+    }
+}
+
+
+
+// A skipped polling read only counts as contender while it overlaps with another transaction.
+// Such a transaction wakes the sleeping tile before its penalty gets computed,
+// because the memory access of the transaction takes time.
+// With more than one sleeping tile, their skipped reads could overlap unnoticed. So only one may sleep.
+bool AXIInterconnect::AllowsPollingFastForward() const
+{
+    return this->policy == ARBITRATIONPOLICY::NONE
+       and this->contender       == 0
+       and this->sleepingpollers == 0;
+}
+
+sc_dt::uint64 AXIInterconnect::GetTransactionCount() const
+{
+    return this->transactions;
+}
+
+void AXIInterconnect::SleepWhilePolling(const sc_core::sc_event &wakeup)
+{
+    this->sleepingpollers++;
+    sc_core::wait(wakeup | this->activityevent);
+    this->sleepingpollers--;
+}
+
+void AXIInterconnect::BeginPolledRead()
+{
+    this->transactions++;
+    this->activityevent.notify();
+    this->contender++;
+}
+
+void AXIInterconnect::EndPolledRead(bool penalty)
+{
+    if(penalty)
+        this->PenaltyWait(tlm::TLM_READ_COMMAND);
+    this->contender--;
+}
+
+void AXIInterconnect::EndPolling(sc_dt::uint64 rounds)
+{
+    this->fastforwardedpolls += rounds;
+}
+
+sc_dt::uint64 AXIInterconnect::GetFastForwardedPolls() const
+{
+    return this->fastforwardedpolls;
+}
+
+
+
+// Without transactions in flight, the bus is idle and nobody is waiting for a grant.
+// Only the round robin position and the statistics remain.
+void AXIInterconnect::SaveState(std::ostream &state) const
+{
+    state::WriteString(state, this->name());
+    state::Write<int32_t>(state, this->lastgranted);
+    state::Write<sc_dt::uint64>(state, this->fastforwardedpolls);
+}
+
+void AXIInterconnect::LoadState(std::istream &state)
+{
+    state::ExpectString(state, this->name());
+    this->lastgranted        = state::Read<int32_t>(state);
+    this->fastforwardedpolls = state::Read<sc_dt::uint64>(state);
 }
 
 
@@ -51,8 +131,8 @@ void AXIInterconnect::PenaltyWait(tlm::tlm_command command)
 void AXIInterconnect::b_transport(int id, tlm::tlm_generic_payload& trans, sc_core::sc_time& delay)
 {
     // Arbitrate the bus. This is a blocking function.
-    // This thread remains inside the function until the bus is granted for this thread.
-    this->Arbitrate();
+    // This thread remains inside the function until the bus is granted for initiator id.
+    this->Arbitrate(id);
 
     // Perform the transaction on the bus
     sc_dt::uint64 global_addr = trans.get_address();
@@ -64,42 +144,210 @@ void AXIInterconnect::b_transport(int id, tlm::tlm_generic_payload& trans, sc_co
         goto exit;
     }
 
+    if(trans.get_data_length() > 4)
+    {
+        // The burst is one transaction for the slave.
+        // The beat accounting charges the penalty of each beat and releases the bus during the beat gaps.
+        core::BurstExtension *burst;
+        trans.get_extension(burst);
+
+        core::BurstExtension nogap;
+        if(burst == nullptr)
+        {
+            burst = &nogap;
+            trans.set_extension(burst);
+        }
+
+        BeatAccounting accounting(this, id);
+        burst->observer = &accounting;
+        this->initiator_socket[slaveid]->b_transport(trans, delay);
+        burst->observer = nullptr;
+
+        if(burst == &nogap)
+            trans.clear_extension(burst);
+        goto exit;
+    }
+
     this->initiator_socket[slaveid]->b_transport(trans, delay);
 
     // Beside the minimal transaction time, there is a penalty depending on the bus contention
     this->PenaltyWait(trans.get_command());
 
 exit:
-    // Release the bus so that the next thread can access the bus
-    this->Release();
+    // Release the bus so that the next initiator can access the bus
+    this->Release(id);
     return;
 }
 
 
 
-void AXIInterconnect::Arbitrate()
+// Same timing as a sequence of single word transactions:
+// Each beat pays the penalty for the contention at its end.
+// During the beat gap, the initiator does not count as contender.
+void AXIInterconnect::BeatAccounting::EndOfBeat(tlm::tlm_command command, const sc_core::sc_time &gap)
+{
+    this->interconnect->PenaltyWait(command);
+
+    if(gap != sc_core::SC_ZERO_TIME)
+    {
+        this->interconnect->Release(this->id);
+        sc_core::wait(gap);
+        this->interconnect->Arbitrate(this->id);
+    }
+}
+
+
+
+void AXIInterconnect::Arbitrate(int id)
 {
+    this->transactions++;
+    this->activityevent.notify();   // Wakes a tile that skips its polling rounds
     this->contender++;
 
-    // Enqueue this thread to get access to the bus
-    size_t thisthread = std::hash<std::thread::id>{}(std::this_thread::get_id());
-    this->requestqueue.push(thisthread);
+    // All initiators access the bus concurrently, only the penalties depend on their number
+    if(this->policy == ARBITRATIONPOLICY::NONE)
+        return;
+
+    // All initiators are bound when the first transaction happens
+    if(this->grantevents.empty())
+    {
+        this->requesting.assign(this->target_socket.size(), false);
+        for(unsigned int i = 0; i < this->target_socket.size(); i++)
+            this->grantevents.emplace_back(new sc_core::sc_event());
+    }
+
+    // Take the bus right away if nobody else is allowed to use it
+    if(this->owner < 0
+    and (this->policy != ARBITRATIONPOLICY::TDMA or this->SlotOwner() == id))
+    {
+        this->Grant(id);
+        return;
+    }
+
+    this->requesting[id] = true;
+    if(this->policy == ARBITRATIONPOLICY::FCFS)
+        this->requestqueue.push_back(id);
 
-    // Wait until the bus gets granted for this thread
-    while(this->requestqueue.front() != thisthread)
-        sc_core::wait(this->busrelease);
+    // Wait until the bus gets granted for this initiator.
+    // Release hands the bus over directly, so only the granted initiator wakes up.
+    while(this->owner != id)
+    {
+        if(this->policy == ARBITRATIONPOLICY::TDMA)
+        {
+            // An idle bus gets taken at the beginning of the own slot
+            if(this->owner < 0 and this->SlotOwner() == id)
+            {
+                this->Grant(id);
+                break;
+            }
+            sc_core::wait(this->TimeToSlot(id), *this->grantevents[id]);
+        }
+        else
+            sc_core::wait(*this->grantevents[id]);
+    }
     return;
 }
 
 
 
-void AXIInterconnect::Release()
+void AXIInterconnect::Release(int id)
 {
     this->contender--;
+    if(this->policy == ARBITRATIONPOLICY::NONE)
+        return;
+
+    this->owner = -1;
+
+    // This initiator is done, let the next initiator access the bus
+    int next = this->SelectNext();
+    if(next >= 0)
+    {
+        this->Grant(next);
+        this->grantevents[next]->notify();
+    }
+}
+
+
+
+void AXIInterconnect::Grant(int id)
+{
+    this->owner          = id;
+    this->lastgranted    = id;
+    this->requesting[id] = false;
+}
+
+
+
+int AXIInterconnect::SelectNext()
+{
+    int initiators = this->requesting.size();
+
+    switch(this->policy)
+    {
+        case ARBITRATIONPOLICY::NONE:
+            return -1;
+
+        case ARBITRATIONPOLICY::FCFS:
+            if(this->requestqueue.empty())
+                return -1;
+            else
+            {
+                int next = this->requestqueue.front();
+                this->requestqueue.pop_front();
+                return next;
+            }
+
+        case ARBITRATIONPOLICY::ROUNDROBIN:
+            for(int i = 1; i <= initiators; i++)
+            {
+                int candidate = (this->lastgranted + i) % initiators;
+                if(this->requesting[candidate])
+                    return candidate;
+            }
+            return -1;
+
+        case ARBITRATIONPOLICY::FIXEDPRIORITY:
+            for(int candidate = 0; candidate < initiators; candidate++)
+            {
+                if(this->requesting[candidate])
+                    return candidate;
+            }
+            return -1;
+
+        case ARBITRATIONPOLICY::TDMA:
+        {
+            int candidate = this->SlotOwner();
+            if(this->requesting[candidate])
+                return candidate;
+            return -1;
+        }
+    }
+    return -1;
+}
+
+
+
+int AXIInterconnect::SlotOwner() const
+{
+    sc_dt::uint64 slotindex = sc_core::sc_time_stamp().value() / this->slot.value();
+    return slotindex % this->requesting.size();
+}
+
+
+
+sc_core::sc_time AXIInterconnect::TimeToSlot(int id) const
+{
+    sc_dt::uint64 now    = sc_core::sc_time_stamp().value();
+    sc_dt::uint64 length = this->slot.value();
+    sc_dt::uint64 period = length * this->requesting.size();
+
+    // Start of the slot of initiator id in the current period.
+    // If it already began, the next period is the earliest chance to get the bus.
+    sc_dt::uint64 start = (now / period) * period + id * length;
+    if(start <= now)
+        start += period;
 
-    // This thread is done, let the next thread access the bus
-    this->requestqueue.pop();
-    this->busrelease.notify();
+    return sc_core::sc_time::from_value(start - now);
 }
 
 // vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -2,31 +2,97 @@
 #define AXI_INTERCONNECT_HPP
 
 #include <hardware/interconnect.hpp>
+#include <core/burstextension.hpp>
 #include <atomic>
-#include <unistd.h>
-#include <functional>
-#include <thread>
-#include <queue>
+#include <memory>
+#include <vector>
+#include <deque>
+
+// Initiators are identified by the target socket they are bound to.
+// NONE does not serialize the initiators. The bus contention is only modeled by the
+// calibrated read and write penalties, which depend on the number of concurrent transactions.
+// The penalty tables were derived for this model, so it is the default.
+// The other policies additionally let an initiator wait until the bus is granted to it:
+// FIXEDPRIORITY prefers the initiator that got bound first.
+// TDMA grants the bus only during the slot of an initiator.
+// The slots are assigned in bind order and repeat periodically.
+enum ARBITRATIONPOLICY
+{
+    NONE,
+    FCFS,
+    ROUNDROBIN,
+    FIXEDPRIORITY,
+    TDMA
+};
 
 class AXIInterconnect
     : public Interconnect
 {
     public:
-        AXIInterconnect(const char* name);
+        AXIInterconnect(const char* name,
+                ARBITRATIONPOLICY policy = ARBITRATIONPOLICY::NONE,
+                sc_core::sc_time  slot   = sc_core::SC_ZERO_TIME);
+
+        // Only without serialization, a sleeping polling tile does not influence the other initiators
+        virtual bool          AllowsPollingFastForward() const;
+        virtual sc_dt::uint64 GetTransactionCount()      const;
+        virtual void SleepWhilePolling(const sc_core::sc_event &wakeup);
+        virtual void BeginPolledRead();
+        virtual void EndPolledRead(bool penalty);
+        virtual void EndPolling(sc_dt::uint64 rounds);
+        sc_dt::uint64 GetFastForwardedPolls() const;
+
+        virtual void SaveState(std::ostream &state) const;
+        virtual void LoadState(std::istream &state);
     
+    protected:
+        // Only serializing policies let other initiators get the bus between two beats.
+        // Without serialization, a burst stays one transaction and BeatAccounting
+        // arbitrates and penalizes each beat like a single word transaction.
+        virtual bool SplitsBurst(const sc_core::sc_time &) const { return this->policy != ARBITRATIONPOLICY::NONE; };
+
     private:
+        class BeatAccounting
+            : public core::BeatObserver
+        {
+            public:
+                BeatAccounting(AXIInterconnect *interconnect, int id)
+                    : interconnect(interconnect)
+                    , id(id) {};
+                virtual void EndOfBeat(tlm::tlm_command command, const sc_core::sc_time &gap);
+
+            private:
+                AXIInterconnect *interconnect;
+                int id;
+        };
+
         virtual void b_transport(int id, tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
         void PenaltyWait(tlm::tlm_command command);
 
-        void Arbitrate();
-        void Release();
+        void Arbitrate(int id);
+        void Release(int id);
+        int  SelectNext();          // -1 if no initiator can be granted
+        void Grant(int id);
+        int  SlotOwner() const;     // Initiator owning the current TDMA slot
+        sc_core::sc_time TimeToSlot(int id) const;
 
         std::atomic<int>  contender;
-        sc_core::sc_event busrelease;
-        std::queue<size_t> requestqueue;
+
+        ARBITRATIONPOLICY policy;
+        sc_core::sc_time  slot;     // TDMA slot length
+        int               owner;    // Initiator holding the bus, -1 if idle
+        int               lastgranted;
+        std::deque<int>   requestqueue; // FCFS order of waiting initiators
+        std::vector<bool> requesting;   // Indexed by initiator
+        std::vector<std::unique_ptr<sc_core::sc_event>> grantevents;
 
         std::vector<int>  readpenalties;
         std::vector<int>  writepenalties;
+
+        sc_dt::uint64     transactions;       // Begun transactions, including replayed polling reads
+        unsigned int      sleepingpollers;    // Tiles skipping their polling rounds
+        sc_core::sc_event activityevent;      // Notified when a transaction begins
+        sc_dt::uint64     fastforwardedpolls; // Polling transactions that were not simulated
 };
 
 
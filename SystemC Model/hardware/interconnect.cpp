@@ -7,6 +7,7 @@
 Interconnect& Interconnect::operator<< (Tile& tile)
 {
     tile.initiator_socket(this->target_socket);
+    tile.SetInterconnect(this);
     return *this;
 }
 
@@ -1,6 +1,8 @@
 #ifndef INTERCONNECT_HPP
 #define INTERCONNECT_HPP
 
+#include <istream>
+#include <ostream>
 #include <core/bus.hpp>
 class Tile;
 class SharedMemory;
@@ -14,6 +16,25 @@ class Interconnect
 
         virtual Interconnect& operator<< (Tile& tile);
         virtual Interconnect& operator<< (SharedMemory& sharedmemory);
+
+        // Polling fast-forward (see Channel::PollCycleAccurate).
+        // A polling tile may only skip its polling rounds while they do not overlap with other transactions.
+        // AllowsPollingFastForward: No transaction in flight and no other tile skipping its polling rounds.
+        // The transaction count tells if a polling round overlapped with other transactions.
+        // SleepWhilePolling returns when wakeup gets notified or when another transaction begins.
+        // BeginPolledRead/EndPolledRead replay the rest of a skipped polling read that overlaps with that transaction.
+        // Interconnects that do not implement this never allow the fast-forward.
+        virtual bool          AllowsPollingFastForward() const { return false; };
+        virtual sc_dt::uint64 GetTransactionCount()      const { return 0; };
+        virtual void SleepWhilePolling(const sc_core::sc_event &wakeup) { sc_core::wait(wakeup); };
+        virtual void BeginPolledRead() {};
+        virtual void EndPolledRead(bool) {};
+        virtual void EndPolling(sc_dt::uint64) {};   // Number of skipped polling rounds, for statistics
+
+        // Arbitration state for checkpoints.
+        // Checkpoints only get taken while no transaction is in flight.
+        virtual void SaveState(std::ostream &) const {};
+        virtual void LoadState(std::istream &) {};
 };
 
 
@@ -1,4 +1,6 @@
 #include <hardware/memory.hpp>
+#include <algorithm>
+#include <statestream.hpp>
 
 unsigned int Memory::GetSize() const
 {
@@ -10,6 +12,11 @@ uint64_t Memory::GetAddress() const
     return this->baseaddress;
 }
 
+const std::string& Memory::GetName() const
+{
+    return this->name;
+}
+
 
 
 unsigned long Memory::Read(uint64_t address) const
@@ -19,17 +26,21 @@ unsigned long Memory::Read(uint64_t address) const
     {
         std::cerr << "\e[1;31mERROR:\e[0m Memory read access out of range. Attempt index: " << index << "; Memory size: " << this->memory.size() << std::endl;
         if(this->monitor)
-            this->monitor->ExpandTrace(this->name, "ERROR");
+            this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::MEMORY_ERROR);
         return 0;
     }
 
     if(this->monitor)
-        this->monitor->ExpandTrace(this->name, "R");
+        this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::MEMORY_READ);
 
     sc_core::wait(this->readdelay);
 
+    auto usagechannel = this->usagechannels.find(address);
+    if(usagechannel != this->usagechannels.end())
+        usagechannel->second->UsageSampled(sc_core::sc_time_stamp());
+
     if(this->monitor)
-        this->monitor->ExpandTrace(this->name, "IDLE");
+        this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::MEMORY_IDLE);
 
     return this->memory[index];
 }
@@ -40,18 +51,78 @@ void Memory::Write(uint64_t address, unsigned long word)
     {
         std::cerr << "\e[1;31mERROR:\e[0m Memory write access out of range. Attempt index: " << index << "; Memory size: " << this->memory.size() << std::endl;
         if(this->monitor)
-            this->monitor->ExpandTrace(this->name, "ERROR");
+            this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::MEMORY_ERROR);
         return;
     }
 
     if(this->monitor)
-        this->monitor->ExpandTrace(this->name, "W");
+        this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::MEMORY_WRITE);
 
     sc_core::wait(this->writedelay);
     this->memory[index] = word;
 
+    auto usagechannel = this->usagechannels.find(address);
+    if(usagechannel != this->usagechannels.end())
+        usagechannel->second->UsageUpdated(word, sc_core::sc_time_stamp());
+
     if(this->monitor)
-        this->monitor->ExpandTrace(this->name, "IDLE");
+        this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::MEMORY_IDLE);
+}
+
+
+
+// Temporal decoupled access:
+// Instead of waiting, the access time gets added to delay.
+// On entry, delay is the local time offset of the caller relative to the SystemC time.
+
+unsigned long Memory::Read(uint64_t address, sc_core::sc_time &delay) const
+{
+    uint64_t index = address - this->baseaddress;
+    if(index >= this->memory.size())
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Memory read access out of range. Attempt index: " << index << "; Memory size: " << this->memory.size() << std::endl;
+        if(this->monitor)
+            this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::MEMORY_ERROR);
+        return 0;
+    }
+
+    if(this->monitor)
+        this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::MEMORY_READ);
+
+    delay += this->readdelay;
+
+    auto usagechannel = this->usagechannels.find(address);
+    if(usagechannel != this->usagechannels.end())
+        usagechannel->second->UsageSampled(sc_core::sc_time_stamp() + delay);
+
+    if(this->monitor)
+        this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::MEMORY_IDLE);
+
+    return this->memory[index];
+}
+void Memory::Write(uint64_t address, unsigned long word, sc_core::sc_time &delay)
+{
+    uint64_t index = address - this->baseaddress;
+    if(index >= this->memory.size())
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Memory write access out of range. Attempt index: " << index << "; Memory size: " << this->memory.size() << std::endl;
+        if(this->monitor)
+            this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::MEMORY_ERROR);
+        return;
+    }
+
+    if(this->monitor)
+        this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::MEMORY_WRITE);
+
+    delay += this->writedelay;
+    this->memory[index] = word;
+
+    auto usagechannel = this->usagechannels.find(address);
+    if(usagechannel != this->usagechannels.end())
+        usagechannel->second->UsageUpdated(word, sc_core::sc_time_stamp() + delay);
+
+    if(this->monitor)
+        this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::MEMORY_IDLE);
 }
 
 
@@ -83,11 +154,32 @@ Memory& Memory::operator<< (Channel& channel)
 
     // remember channel
     this->channels.push_back(&channel);
+    this->usagechannels[channel.usageaddress] = &channel;
     return *this;
 }
 
 
 
+// The vector keeps its storage, so DMI pointers granted for this memory stay valid
+void Memory::SaveState(std::ostream &state) const
+{
+    state::WriteString(state, this->name);
+    state::WriteVector(state, this->memory);
+}
+
+void Memory::LoadState(std::istream &state)
+{
+    state::ExpectString(state, this->name);
+
+    std::vector<unsigned long> contents;
+    state::ReadVector(state, contents);
+    if(contents.size() != this->memory.size())
+        throw std::runtime_error("Checkpoint does not match the size of memory " + this->name);
+    std::copy(contents.begin(), contents.end(), this->memory.begin());
+}
+
+
+
 Channel* Memory::GetChannelByOffset(unsigned long long offset)
 {
     for(size_t i = 0; i < this->channels.size(); i++)
@@ -107,5 +199,51 @@ Channel* Memory::GetChannelByOffset(unsigned long long offset)
 
 
 
+// Direct Memory Interface ///////////////
+
+
+// The whole memory gets granted at once.
+// There is one unsigned long per word address, so an initiator accesses address a
+// by reading element (a - start address) of the DMI pointer.
+// DMI accesses are not visible to the channels usage hooks and to the trace.
+bool SharedMemory::get_direct_mem_ptr(tlm::tlm_generic_payload&, tlm::tlm_dmi &dmi)
+{
+    if(this->dmidisabled)
+        return false;
+
+    dmi.set_dmi_ptr(reinterpret_cast<unsigned char*>(this->memory.data()));
+    dmi.set_start_address(this->baseaddress);
+    dmi.set_end_address(this->baseaddress + this->memory.size() - 1);
+    dmi.set_read_latency(this->readdelay);
+    dmi.set_write_latency(this->writedelay);
+    dmi.allow_read_write();
+    return true;
+}
+
+
+
+void SharedMemory::DisableDMI()
+{
+    this->dmidisabled = true;
+    this->InvalidateDMI();
+}
+
+
+
+void SharedMemory::LoadState(std::istream &state)
+{
+    this->Memory::LoadState(state);
+    this->InvalidateDMI();
+}
+
+
+
+void SharedMemory::InvalidateDMI()
+{
+    this->InvalidateDirectMemPtr(this->baseaddress, this->baseaddress + this->memory.size() - 1);
+}
+
+
+
 // vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
 
@@ -3,6 +3,9 @@
 
 #include <vector>
 #include <string>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
 #include <core/slave.hpp>
 #include <software/channel.hpp>
 #include <monitor.hpp>
@@ -18,6 +21,7 @@ class Memory
             , writedelay(writedelay)
             , name(name)
             , monitor(&monitor)
+            , tracesignal(monitor.RegisterSignal(name))
             {};
         Memory(std::string name, uint64_t address, size_t size, sc_core::sc_time readdelay, sc_core::sc_time writedelay)
             : baseaddress(address), size(size), used(0), channels(0)
@@ -26,18 +30,29 @@ class Memory
             , writedelay(writedelay)
             , name(name)
             , monitor(nullptr)
+            , tracesignal(0)
             {};
 
         unsigned int GetSize() const; // in words
         uint64_t GetAddress() const;
+        const std::string& GetName() const;
 
         virtual unsigned long Read(uint64_t address) const;
         virtual void Write(uint64_t address, unsigned long word);
 
+        // Temporal decoupled access. The access time gets added to delay instead of waiting.
+        unsigned long Read(uint64_t address, sc_core::sc_time &delay) const;
+        void Write(uint64_t address, unsigned long word, sc_core::sc_time &delay);
+
         Memory& operator<< (Channel& channel); 
 
+        // Contents of the memory for checkpoints.
+        // Loading does not trigger the usage hooks of the channels, they restore their own state.
+        void SaveState(std::ostream &state) const;
+        virtual void LoadState(std::istream &state);
 
-    private:
+
+    protected:
         std::string name;
         unsigned long long AllocateMemory(size_t numbytes);
         Channel* GetChannelByOffset(unsigned long long offset);
@@ -46,12 +61,15 @@ class Memory
         size_t used; // used words
         uint64_t baseaddress;
         std::vector<Channel*> channels;
+        std::unordered_map<uint64_t, Channel*> usagechannels; // usage address -> channel
         std::vector<unsigned long> memory;
 
         Monitor *monitor;   // Can be NULL!
 
         sc_core::sc_time readdelay;
         sc_core::sc_time writedelay;
+
+        TraceSignal tracesignal;
 };
 
 
@@ -64,10 +82,12 @@ class SharedMemory : public core::Slave, public Memory
         SharedMemory(std::string name, sc_dt::uint64 address, size_t size, sc_core::sc_time readdelay, sc_core::sc_time writedelay)
             : core::Slave(name.c_str())
             , Memory(name, address, size, readdelay, writedelay)
+            , dmidisabled(false)
             {};
         SharedMemory(std::string name, sc_dt::uint64 address, size_t size, sc_core::sc_time readdelay, sc_core::sc_time writedelay, Monitor &monitor)
             : core::Slave(name.c_str())
             , Memory(name, address, size, readdelay, writedelay, monitor)
+            , dmidisabled(false)
             {};
         virtual unsigned long Read(uint64_t address) const
         {
@@ -77,6 +97,19 @@ class SharedMemory : public core::Slave, public Memory
         {
             this->Memory::Write(address, word);
         }
+
+        // The trace and the usage hooks of the channels (polling fast-forward) only see accesses via Read and Write.
+        // Disabling DMI withdraws all DMI pointers granted so far.
+        void DisableDMI();
+
+        // The initiators request their DMI pointers again after loading a checkpoint
+        virtual void LoadState(std::istream &state);
+
+    private:
+        virtual bool get_direct_mem_ptr(tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi);
+        void InvalidateDMI();   // Withdraws all DMI pointers granted for this memory
+
+        bool dmidisabled;
 };
 
 
@@ -1,23 +1,34 @@
 #include <iostream>
 
 #include <hardware/tile.hpp>
+#include <checkpoint.hpp>
+#include <interruption.hpp>
 
 const sc_core::sc_time privatereaddelay( 9, sc_core::SC_NS); // \_ per token
 const sc_core::sc_time privatewritedelay(7, sc_core::SC_NS); // /
 
-Tile::Tile(sc_core::sc_module_name name, unsigned int maxiterations)
+Tile::Tile(sc_core::sc_module_name name, uint64_t maxiterations)
     : core::Master(sc_core::sc_module_name(name))
     , PrivateMemory(std::string(static_cast<const char*>(name))+".PM", 0x00000000, 32*1024, privatereaddelay, privatewritedelay)
     , maxiterations(maxiterations)
     , name(std::string(static_cast<const char*>(name)))
+    , monitor(nullptr)
+    , tracesignal(0)
+    , interconnect(nullptr)
+    , checkpoint(nullptr)
+    , decoupled(false)
 {
 }
-Tile::Tile(sc_core::sc_module_name name, unsigned int maxiterations, Monitor &monitor)
+Tile::Tile(sc_core::sc_module_name name, uint64_t maxiterations, Monitor &monitor)
     : core::Master(sc_core::sc_module_name(name))
     , PrivateMemory(std::string(static_cast<const char*>(name))+".PM", 0x00000000, 32*1024, privatereaddelay, privatewritedelay, monitor)
     , maxiterations(maxiterations)
     , monitor(&monitor)
     , name(std::string(static_cast<const char*>(name)))
+    , tracesignal(monitor.RegisterSignal(this->name))
+    , interconnect(nullptr)
+    , checkpoint(nullptr)
+    , decoupled(false)
 {
 }
 
@@ -34,32 +45,148 @@ Tile& Tile::operator<< (Actor& actor)
 
 void Tile::Execute()
 {
+    this->quantumkeeper.reset();
+
     for(auto actor : this->actors)
         actor->Initialize();
 
+    // A resumed simulation continues after the iteration of the checkpoint.
+    // The local time gets reset after each wait for the other tiles,
+    // so the tiles continue the same way after a checkpoint and after resuming.
+    uint64_t first = 0;
+    if(this->checkpoint)
+    {
+        first = this->checkpoint->Resume(this);
+        this->quantumkeeper.reset();
+    }
+
     if(this->monitor)
-        this->monitor->ExpandTrace(this->name, "ACTIVE");   // Processing Element is active now
+        this->monitor->ExpandTrace(this->tracesignal, TRACEPHASE::TILE_ACTIVE);   // Processing Element is active now
 
-    for(unsigned int i=0; i<this->maxiterations; i++)
+    for(uint64_t i=first; i<this->maxiterations; i++)
     {
         for(auto actor : this->actors)
             actor->Execute();
+
+        // Stopping between iterations leaves no partial iteration of this tile behind
+        if(Interruption::IsRequested())
+        {
+            if(this->monitor)
+                this->monitor->Interrupt();
+            else
+                sc_core::sc_stop();
+            break;
+        }
+
+        if(this->checkpoint and this->checkpoint->IsDue(i+1) and i+1 < this->maxiterations)
+        {
+            this->Synchronize();
+            this->checkpoint->Barrier(this, i+1);
+            this->quantumkeeper.reset();
+        }
     }
+
+    this->Synchronize();
 }
 
 
 
-void Tile::WriteWord(sc_dt::uint64 addr, unsigned int* word)
+void Tile::SetMaxIterations(uint64_t maxiterations)
+{
+    this->maxiterations = maxiterations;
+}
+
+bool Tile::HasActors() const
+{
+    return not this->actors.empty();
+}
+
+void Tile::SetCheckpoint(Checkpoint *checkpoint)
+{
+    this->checkpoint = checkpoint;
+}
+
+
+
+void Tile::EnableTemporalDecoupling(bool enable)
+{
+    this->decoupled = enable;
+}
+
+
+
+void Tile::Wait(const sc_core::sc_time &delay)
+{
+    if(not this->decoupled)
+    {
+        sc_core::wait(delay);
+        return;
+    }
+
+    this->quantumkeeper.inc(delay);
+    if(this->quantumkeeper.need_sync())
+        this->quantumkeeper.sync();
+}
+
+
+
+void Tile::Synchronize()
+{
+    if(this->decoupled and this->quantumkeeper.get_local_time() != sc_core::SC_ZERO_TIME)
+        this->quantumkeeper.sync();
+}
+
+
+
+sc_core::sc_time Tile::GetCurrentTime() const
+{
+    if(this->decoupled)
+        return this->quantumkeeper.get_current_time();
+
+    return sc_core::sc_time_stamp();
+}
+
+
+
+void Tile::SetInterconnect(Interconnect *interconnect)
+{
+    this->interconnect = interconnect;
+}
+
+Interconnect* Tile::GetInterconnect() const
+{
+    return this->interconnect;
+}
+
+
+
+bool Tile::IsPrivateAddress(sc_dt::uint64 addr) const
 {
     auto privatebegin = this->PrivateMemory::GetAddress();
     auto privateend   = this->PrivateMemory::GetAddress() + this->PrivateMemory::GetSize();
 
-    if(addr >= privatebegin and addr < privateend)  // Access Private Memory
+    return addr >= privatebegin and addr < privateend;
+}
+
+
+
+void Tile::WriteWord(sc_dt::uint64 addr, unsigned int* word)
+{
+    if(this->IsPrivateAddress(addr) and this->decoupled)
+    {
+        sc_core::sc_time localtime = this->quantumkeeper.get_local_time();
+        this->PrivateMemory::Write(addr, *word, localtime);
+        this->quantumkeeper.set(localtime);
+        if(this->quantumkeeper.need_sync())
+            this->quantumkeeper.sync();
+    }
+    else if(this->IsPrivateAddress(addr))           // Access Private Memory
     {
         this->PrivateMemory::Write(addr, *word);
     }
     else                                            // Access Interconnect
     {
+        this->Synchronize();
         this->core::Master::WriteWord(addr, word);
     }
 }
@@ -68,19 +195,62 @@ void Tile::WriteWord(sc_dt::uint64 addr, unsigned int* word)
 
 void Tile::ReadWord( sc_dt::uint64 addr, unsigned int* word)
 {
-    auto privatebegin = this->PrivateMemory::GetAddress();
-    auto privateend   = this->PrivateMemory::GetAddress() + this->PrivateMemory::GetSize();
-    unsigned long retval;
-
-    if(addr >= privatebegin and addr < privateend)  // Access Private Memory
+    if(this->IsPrivateAddress(addr) and this->decoupled)
+    {
+        sc_core::sc_time localtime = this->quantumkeeper.get_local_time();
+        *word = this->PrivateMemory::Read(addr, localtime);
+        this->quantumkeeper.set(localtime);
+        if(this->quantumkeeper.need_sync())
+            this->quantumkeeper.sync();
+    }
+    else if(this->IsPrivateAddress(addr))           // Access Private Memory
     {
         *word = this->PrivateMemory::Read(addr);
     }
     else                                            // Access Interconnect
     {
+        this->Synchronize();
         this->core::Master::ReadWord(addr, word);
     }
 }
 
+void Tile::WriteBurst(sc_dt::uint64 addr, unsigned int* words, unsigned int count, sc_core::sc_time beatgap)
+{
+    if(this->IsPrivateAddress(addr))                // Access Private Memory
+    {
+        for(unsigned int i = 0; i < count; i++)
+        {
+            this->WriteWord(addr + i, &words[i]);
+            if(i + 1 < count and beatgap != sc_core::SC_ZERO_TIME)
+                this->Wait(beatgap);
+        }
+    }
+    else                                            // Access Interconnect
+    {
+        this->Synchronize();
+        this->core::Master::WriteBurst(addr, words, count, beatgap);
+    }
+}
+
+
+
+void Tile::ReadBurst( sc_dt::uint64 addr, unsigned int* words, unsigned int count, sc_core::sc_time beatgap)
+{
+    if(this->IsPrivateAddress(addr))                // Access Private Memory
+    {
+        for(unsigned int i = 0; i < count; i++)
+        {
+            this->ReadWord(addr + i, &words[i]);
+            if(i + 1 < count and beatgap != sc_core::SC_ZERO_TIME)
+                this->Wait(beatgap);
+        }
+    }
+    else                                            // Access Interconnect
+    {
+        this->Synchronize();
+        this->core::Master::ReadBurst(addr, words, count, beatgap);
+    }
+}
+
 // vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
 
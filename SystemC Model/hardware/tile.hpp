@@ -1,32 +1,63 @@
 #ifndef TILE_HPP
 #define TILE_HPP
 
+#include <tlm_utils/tlm_quantumkeeper.h>
 #include <core/master.hpp>
 #include <hardware/memory.hpp>
 #include <software/actor.hpp>
 #include <monitor.hpp>
 
 class Channel;
+class Interconnect;
+class Checkpoint;
 
 class Tile : public core::Master, public PrivateMemory
 {
     public:
-        Tile(sc_core::sc_module_name name, unsigned int maxiterations = 1000000);
-        Tile(sc_core::sc_module_name name, unsigned int maxiterations, Monitor &monitor);
+        Tile(sc_core::sc_module_name name, uint64_t maxiterations = 1000000);
+        Tile(sc_core::sc_module_name name, uint64_t maxiterations, Monitor &monitor);
         virtual ~Tile(){};
 
         Tile& operator<< (Actor& actor); 
 
         virtual void Execute();
+        void SetMaxIterations(uint64_t maxiterations); // Only before the simulation starts
+        bool HasActors() const;
+
+        // The tile waits for the other tiles at each checkpoint,
+        // and continues after the iteration of a loaded checkpoint (see checkpoint.hpp)
+        void SetCheckpoint(Checkpoint *checkpoint);
         void WriteWord(sc_dt::uint64 addr, unsigned int* word);
         void ReadWord( sc_dt::uint64 addr, unsigned int* word);
+        void WriteBurst(sc_dt::uint64 addr, unsigned int* words, unsigned int count, sc_core::sc_time beatgap = sc_core::SC_ZERO_TIME);
+        void ReadBurst( sc_dt::uint64 addr, unsigned int* words, unsigned int count, sc_core::sc_time beatgap = sc_core::SC_ZERO_TIME);
+
+        bool IsPrivateAddress(sc_dt::uint64 addr) const;
+
+        void SetInterconnect(Interconnect *interconnect);
+        Interconnect* GetInterconnect() const;
+
+        // Temporal decoupling:
+        // Accesses to the private memory and Wait calls only increase the local time of the tile.
+        // The tile synchronizes with the SystemC time before any interaction with other tiles,
+        // or when the local time exceeds the global quantum.
+        void EnableTemporalDecoupling(bool enable=true);
+        void Wait(const sc_core::sc_time &delay);
+        void Synchronize();
+        sc_core::sc_time GetCurrentTime() const; // SystemC time + local time offset
 
     protected:
         std::vector<Actor*> actors;
-        unsigned int        maxiterations;
+        uint64_t            maxiterations;
         std::string         name;
 
         Monitor             *monitor;   // Can be NULL!
+        TraceSignal         tracesignal;
+        Interconnect        *interconnect; // Can be NULL!
+        Checkpoint          *checkpoint;   // Can be NULL!
+
+        bool                           decoupled;
+        tlm_utils::tlm_quantumkeeper   quantumkeeper;
 };
 
 #endif
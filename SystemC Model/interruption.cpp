@@ -0,0 +1,49 @@
+#include <interruption.hpp>
+#include <unistd.h>
+
+volatile sig_atomic_t Interruption::signal = 0;
+
+
+
+void Interruption::Install()
+{
+    struct sigaction action;
+    action.sa_handler = Interruption::Handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0;
+    sigaction(SIGINT,  &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+
+
+
+// Only async-signal-safe calls in here
+void Interruption::Handler(int signal)
+{
+    if(Interruption::signal != 0)
+        _exit(128 + signal);
+    Interruption::signal = signal;
+
+    static const char message[] = "\n\e[1;33mInterrupted - stopping after the current iteration\e[1;30m (again to abort immediately)\e[0m\n";
+    ssize_t written = write(STDERR_FILENO, message, sizeof(message) - 1);
+    (void)written;
+}
+
+
+
+bool Interruption::IsRequested()
+{
+    return Interruption::signal != 0;
+}
+
+int Interruption::GetSignal()
+{
+    return Interruption::signal;
+}
+
+int Interruption::GetExitStatus()
+{
+    return 128 + Interruption::signal;
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,31 @@
+#ifndef INTERRUPTION_HPP
+#define INTERRUPTION_HPP
+
+#include <csignal>
+
+// Cooperative stop of a simulation on SIGINT and SIGTERM.
+//
+// The signal handler only sets a flag. The tiles check it after each iteration and stop the simulation
+// with sc_stop, so the simulation ends like a regular one: The sample sink gets closed
+// and the summary covers the iterations that were completed.
+// Forked workers and sweep experiments inherit the handlers. They run in their own process group,
+// so a signal from the terminal (Ctrl+C) only reaches the parent. The parent forwards it once to its running children
+// (ParallelRun::Wait, ExperimentSweep::Run), so each process receives the signal exactly once.
+//
+// A second signal terminates the process immediately, for example while the delay vectors get loaded.
+
+class Interruption
+{
+    public:
+        static void Install();          // Handles SIGINT and SIGTERM from now on
+        static bool IsRequested();
+        static int  GetSignal();        // 0 if no signal arrived
+        static int  GetExitStatus();    // 128 + signal, like the shell reports a killed process
+
+    private:
+        static void Handler(int signal);
+        static volatile sig_atomic_t signal;
+};
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
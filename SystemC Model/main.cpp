@@ -4,13 +4,19 @@
 #include <tlm.h>
 #include <systemc.h>
 #include <cstdlib>
-#include <signal.h>
+#include <cerrno>
+#include <cstring>
 #include <unistd.h>
+#include <sys/stat.h>
+#include <sstream>
 
 #include <vector>
 #include <string>
 #include <fstream>
 #include <random>
+#include <memory>
+#include <thread>
+#include <unordered_map>
 
 #include <hardware/tile.hpp>
 #include <hardware/memory.hpp>
@@ -42,6 +48,13 @@ sc_core::sc_time writedelay(9, sc_core::SC_NS); // /
 // This leads to over optimistic results for many processing elements.
 
 #include <monitor.hpp>
+#include <samplesink.hpp>
+#include <delayvectorregistry.hpp>
+#include <experimentsweep.hpp>
+#include <parallelrun.hpp>
+#include <stoppingrule.hpp>
+#include <checkpoint.hpp>
+#include <interruption.hpp>
 #include <sdfg/sobel2.hpp>
 #include <sdfg/jpeg.hpp>
 
@@ -49,180 +62,156 @@ void PrintUsage()
 {
     cerr << "--iterations   -i    - Define number of iterations to simulate (default: 1000000)\n";
     cerr << "--skip         -s    - Define number of iterations to skip in the simulation (default: 0)\n";
+    cerr << "--seed               - Seed of the random number generators for the gaussian and uniform model (default: 0)\n";
     cerr << "--experiment   -e    - Select the experiment that shall be simulated (mandatory parameter)\n";
+    cerr << "--fastforward  -p    - Fast-forward polling in the cycle accurate communication model\n";
+    cerr << "--quantum      -q    - Enable temporal decoupling of the tiles with a quantum given in ns\n";
+    cerr << "--sink         -k    - Format of the iteration durations: text (default) or binary\n";
+    cerr << "--output       -o    - Write the iteration durations into a file instead of stdout\n";
+    cerr << "--summary            - Write statistics of the iteration durations as JSON into a file (default: stderr)\n";
+    cerr << "--exact        -x    - Simulate all iterations of deterministic models instead of extrapolating periodic behavior\n";
+    cerr << "--kde-crosscheck     - Compare the native KDE with the results of setup/kde.py\n";
+    cerr << "--no-cache           - Do not use the cache for processed delay vectors in ~/.smcdelaycache\n";
+    cerr << "--stream             - Stream injected delays from the timing files instead of loading them completely\n";
+    cerr << "--stream-shuffle     - Like --stream, but shuffle each block of streamed delays\n";
+    cerr << "--jobs               - Split the iterations over the given number of worker processes (default: 1)\n";
+    cerr << "--warmup             - Discarded iterations each worker simulates before its share of iterations (default: 1000)\n";
+    cerr << "--precision          - Stop as soon as the confidence interval of the mean is smaller than this fraction of the mean (e.g. 0.01)\n";
+    cerr << "--precision-quantile - Require the precision for this quantile (e.g. 0.99) instead of the mean, can be given several times\n";
+    cerr << "--confidence         - Confidence level of the precision (default: 0.95)\n";
+    cerr << "--checkpoint         - Write a checkpoint every given number of iterations (default: 0, no checkpoints, functional model only)\n";
+    cerr << "--checkpoint-file    - Path of the checkpoint (default: <output>.checkpoint or <experiment>.checkpoint)\n";
+    cerr << "--resume             - Continue the simulation from its last checkpoint\n";
+    cerr << "--sweep              - Run all experiments matching the pattern (e.g. \"mdpi-Sobel2-*\"), can be given several times\n";
+    cerr << "--sweep-jobs         - Number of experiments of a sweep that run at the same time (default: number of cores)\n";
 }
 
 
-void CancelSimulation(sig_atomic_t s)
+// Settings from the command line
+struct SimulationOptions
 {
-    PythonWrapper &pythonwrapper = PythonWrapper::GetInstance();
-    pythonwrapper.ForceShutdown();
-    Python &python = Python::GetInstance();
-    python.ForceShutdown();
-    exit(1); 
-}
-
-
-int sc_main(int argc, char *argv[])
-{
-    std::srand(0); // 0 is the seed - this is not very random but OK in this case
-
-    // Read command line parameters
-    unsigned int maxiterations = 1000000;
-    unsigned int skipsamples   = 0;
-    std::string  experimentname= "null";
-    DISTRIBUTION distribution  = DISTRIBUTION::INJECTED;
+    uint64_t           seed               = 0;
+    uint64_t           maxiterations      = 1000000;
+    uint64_t           skipsamples        = 0;
+    std::string        experimentname     = "null";
+    DISTRIBUTION       distribution       = DISTRIBUTION::INJECTED;
     COMMUNICATIONMODEL communicationmodel = COMMUNICATIONMODEL::CYCLEACCURATE;
-    bool datadependentdelay    = false;
-    bool         functional    = false;
-    const char*  tracepath     = nullptr;
-
-    for(int i=0; i<argc; i++)
-    {
-        if((strncmp("--help", argv[i], 20) == 0) || (strncmp("-h", argv[i], 20) == 0))
-        {
-            PrintUsage();
-            exit(EXIT_SUCCESS);
-        }
-        if((strncmp("--iterations", argv[i], 20) == 0) || (strncmp("-i", argv[i], 20) == 0))
-        {
-            i++;
-            if(i >= argc)
-            {
-                cerr << "Invalid use of --iteration. Argument expected!\n";
-                PrintUsage();
-                exit(EXIT_FAILURE);
-            }
-            maxiterations = stol(std::string(argv[i]));
-            cerr << "\e[1;33mLimiting iterations to " << maxiterations << "\e[0m\n";
-        }
-        if((strncmp("--skip", argv[i], 20) == 0) || (strncmp("-s", argv[i], 20) == 0))
-        {
-            i++;
-            if(i >= argc)
-            {
-                cerr << "Invalid use of --skip. Argument expected!\n";
-                PrintUsage();
-                exit(EXIT_FAILURE);
-            }
-            skipsamples = stol(std::string(argv[i]));
-            cerr << "\e[1;33mSkipping " << skipsamples << " samples\e[0m\n";
-        }
-        if((strncmp("--experiment", argv[i], 20) == 0) || (strncmp("-e", argv[i], 20) == 0))
-        {
-            i++;
-            if(i >= argc)
-            {
-                cerr << "Invalid use of --experiment. Argument expected!\n";
-                PrintUsage();
-                exit(EXIT_FAILURE);
-            }
-            experimentname = std::string(argv[i]);
-            cerr << "\e[1;37mRunning experiment " << experimentname << "\e[0m\n";
-        }
-        if((strncmp("--functional", argv[i], 20) == 0) || (strncmp("-f", argv[i], 20) == 0))
-        {
-            std::cerr << "\e[1;31mDEPRECATED: \e[0mUse attribute inside the XML file that describes the experiment!\n";
-            functional = true;
-            cerr << "\e[1;33mRunning functional test\e[0m\n";
-        }
-        if((strncmp("--communicationmodel", argv[i], 20) == 0) || (strncmp("-c", argv[i], 20) == 0))
-        {
-            std::cerr << "\e[1;31mDEPRECATED: \e[0mUse the XML file that describes the experiment!\n";
-            i++;
-            if(i >= argc)
-            {
-                cerr << "Invalid use of --communicationmodel. Argument expected!\n";
-                PrintUsage();
-                exit(EXIT_FAILURE);
-            }
-
-            auto modelname = std::string(argv[i]);
-            
-            if(modelname == "cycleaccurate")
-                communicationmodel = COMMUNICATIONMODEL::CYCLEACCURATE;
-            else if(modelname == "systemcevents")
-                communicationmodel = COMMUNICATIONMODEL::SYSTEMCEVENTS;
-            else
-            {
-                cerr << "\e[1;31mERROR\e[0m Communication Model " << modelname << " not known.\e[0m\n";
-                PrintUsage();
-                exit(EXIT_FAILURE);
-            }
+    bool               datadependentdelay = false;
+    bool               functional         = false;
+    const char*        tracepath          = nullptr;
+    bool               fastforward        = false;
+    unsigned int       quantum            = 0;     // in ns. 0: No temporal decoupling
+    bool               binarysink         = false;
+    const char*        outputpath         = nullptr;
+    const char*        summarypath        = nullptr;
+    bool               extrapolate        = true;
+    unsigned int       jobs               = 1;
+    uint64_t           warmup             = 1000;
+    double             precision          = 0.0;   // 0: Simulate all iterations
+    std::vector<double> precisionquantiles;
+    double             confidence         = 0.95;
+    uint64_t           checkpointinterval = 0;     // in iterations. 0: No checkpoints
+    const char*        checkpointpath     = nullptr;
+    bool               resume             = false;
+};
+
+
+
+// Delay vectors of all actors, indexed by actor name and feature
+typedef std::unordered_map<std::string, DelayVectorMap> ActorDelayVectors;
+
+// Creating the delay vectors is cheap. They get loaded on demand or by DelayVectorRegistry::Preload.
+ActorDelayVectors CreateDelayVectors(DelayVectorRegistry &delayvectors, DISTRIBUTION distribution, uint64_t skipsamples)
+{
+    ActorDelayVectors actordelays;
 
-            cerr << "\e[1;34mUsing communication model " << modelname << "\e[0m\n";
-        }
-        if((strncmp("--distribution", argv[i], 20) == 0) || (strncmp("-d", argv[i], 20) == 0))
-        {
-            std::cerr << "\e[1;31mDEPRECATED: \e[0mUse the XML file that describes the experiment!\n";
-            i++;
-            if(i >= argc)
-            {
-                cerr << "Invalid use of --distribution. Argument expected!\n";
-                PrintUsage();
-                exit(EXIT_FAILURE);
-            }
+    // Sobel2 Timings
+#define SOBEL2_DelayVector(a) delayvectors.Get(sobel2directory + a , distribution, skipsamples)
+    std::string sobel2directory = "../PlatformV2/timings/sobel2/bram/";
+    DelayVectorMap &getpixel2_delay = actordelays["GetPixel2"];
+    DelayVectorMap &gx2_delay       = actordelays["GX2"];
+    DelayVectorMap &gy2_delay       = actordelays["GY2"];
+    DelayVectorMap &abs2_delay      = actordelays["ABS2"];
+
+    getpixel2_delay["none"] = SOBEL2_DelayVector("GetPixel.txt");
+    getpixel2_delay["ea"]   = SOBEL2_DelayVector("GetPixel-ea.txt");
+    getpixel2_delay["ef"]   = SOBEL2_DelayVector("GetPixel-ef.txt");
+    gx2_delay["none"]       = SOBEL2_DelayVector("GX.txt");
+    gx2_delay["ea"]         = SOBEL2_DelayVector("GX-ea.txt");
+    gx2_delay["ef"]         = SOBEL2_DelayVector("GX-ef.txt");
+    gy2_delay["none"]       = SOBEL2_DelayVector("GY.txt");
+    gy2_delay["ea"]         = SOBEL2_DelayVector("GY-ea.txt");
+    gy2_delay["ef"]         = SOBEL2_DelayVector("GY-ef.txt");
+    abs2_delay["none"]      = SOBEL2_DelayVector("ABS.txt");
+    abs2_delay["ea"]        = SOBEL2_DelayVector("ABS-ea.txt");
+    abs2_delay["ef"]        = SOBEL2_DelayVector("ABS-ef.txt");
+#undef SOBEL2_DelayVector
 
-            auto distributionname = std::string(argv[i]);
-            
-            if(distributionname == "injected")
-                distribution  = DISTRIBUTION::INJECTED;
-            else if(distributionname == "gaussian")
-                distribution  = DISTRIBUTION::GAUSSIAN;
-            else if(distributionname == "uniform")
-                distribution  = DISTRIBUTION::UNIFORM;
-            else if(distributionname == "wcet")
-                distribution  = DISTRIBUTION::WCET;
-            else if(distributionname == "gaussian_kde")
-                distribution  = DISTRIBUTION::GAUSSIAN_KDE;
-            else if(distributionname == "explicit")
-                datadependentdelay = true;
-            else
-            {
-                cerr << "\e[1;31mERROR\e[0m Distribution " << distributionname << " not known.\e[0m\n";
-                PrintUsage();
-                exit(EXIT_FAILURE);
-            }
+    // JPEG Timings
+#define JPEG_DelayVector(a) delayvectors.Get(jpegdirectory + a , distribution, skipsamples)
+    std::string jpegdirectory = "../PlatformV2/timings/jpeg/bram/";
+    DelayVectorMap &getencodedimageblock_delay = actordelays["GetEncodedImageBlock"];
+    DelayVectorMap &iq_y_delay                 = actordelays["IQ_Y"];
+    DelayVectorMap &iq_cr_delay                = actordelays["IQ_Cr"];
+    DelayVectorMap &iq_cb_delay                = actordelays["IQ_Cb"];
+    DelayVectorMap &idct_y_delay               = actordelays["IDCT_Y"];
+    DelayVectorMap &idct_cr_delay              = actordelays["IDCT_Cr"];
+    DelayVectorMap &idct_cb_delay              = actordelays["IDCT_Cb"];
+    DelayVectorMap &creatergbpixels_delay      = actordelays["CreateRGBPixels"];
+
+    getencodedimageblock_delay["none"] = JPEG_DelayVector("GetEncodedImageBlock.txt");
+    getencodedimageblock_delay["ea"]   = JPEG_DelayVector("GetEncodedImageBlock-ea.txt");
+    getencodedimageblock_delay["ef"]   = JPEG_DelayVector("GetEncodedImageBlock-ef.txt");
+
+    iq_y_delay["none"]                 = JPEG_DelayVector("InverseQuantization_Y.txt");
+    iq_y_delay["ea"]                   = JPEG_DelayVector("InverseQuantization_Y-ea.txt");
+    iq_y_delay["ef"]                   = JPEG_DelayVector("InverseQuantization_Y-ef.txt");
+    iq_cr_delay["none"]                = JPEG_DelayVector("InverseQuantization_Cr.txt");
+    iq_cr_delay["ea"]                  = JPEG_DelayVector("InverseQuantization_Cr-ea.txt");
+    iq_cr_delay["ef"]                  = JPEG_DelayVector("InverseQuantization_Cr-ef.txt");
+    iq_cb_delay["none"]                = JPEG_DelayVector("InverseQuantization_Cb.txt");
+    iq_cb_delay["ea"]                  = JPEG_DelayVector("InverseQuantization_Cb-ea.txt");
+    iq_cb_delay["ef"]                  = JPEG_DelayVector("InverseQuantization_Cb-ef.txt");
+
+    idct_y_delay["none"]               = JPEG_DelayVector("IDCT_Y.txt");
+    idct_y_delay["ea"]                 = JPEG_DelayVector("IDCT_Y-ea.txt");
+    idct_y_delay["ef"]                 = JPEG_DelayVector("IDCT_Y-ef.txt");
+    idct_cr_delay["none"]              = JPEG_DelayVector("IDCT_Cr.txt");
+    idct_cr_delay["ea"]                = JPEG_DelayVector("IDCT_Cr-ea.txt");
+    idct_cr_delay["ef"]                = JPEG_DelayVector("IDCT_Cr-ef.txt");
+    idct_cb_delay["none"]              = JPEG_DelayVector("IDCT_Cb.txt");
+    idct_cb_delay["ea"]                = JPEG_DelayVector("IDCT_Cb-ea.txt");
+    idct_cb_delay["ef"]                = JPEG_DelayVector("IDCT_Cb-ef.txt");
+
+    creatergbpixels_delay["none"]      = JPEG_DelayVector("CreateRGBPixels.txt");
+    creatergbpixels_delay["ea"]        = JPEG_DelayVector("CreateRGBPixels-ea.txt");
+    creatergbpixels_delay["ef"]        = JPEG_DelayVector("CreateRGBPixels-ef.txt");
+#undef JPEG_DelayVector
 
-            cerr << "\e[1;34mUsing distribution " << distributionname << "\e[0m\n";
-        }
-        if((strncmp("--trace", argv[i], 20) == 0) || (strncmp("-t", argv[i], 20) == 0))
-        {
-            i++;
-            if(i >= argc)
-            {
-                cerr << "Invalid use of --trace. Argument expected!\n";
-                PrintUsage();
-                exit(EXIT_FAILURE);
-            }
+    return actordelays;
+}
 
-            tracepath = argv[i];
-            
-            cerr << "\e[1;34mWriting trace into " << tracepath << "\e[0m\n";
-        }
-    }
 
-    struct sigaction sigIntHandler;
 
-    sigIntHandler.sa_handler = CancelSimulation;
-    sigemptyset(&sigIntHandler.sa_mask);
-    sigIntHandler.sa_flags = 0;
-    sigaction(SIGINT, &sigIntHandler, NULL);
+// Elaborates and simulates one experiment.
+// The models selected in the experiment's XML file override the models of the command line.
+int RunExperiment(std::string experimentpath, const std::string &experimentname,
+                  const SimulationOptions &options, DelayVectorRegistry &delayvectors)
+{
+    DISTRIBUTION       distribution       = options.distribution;
+    COMMUNICATIONMODEL communicationmodel = options.communicationmodel;
+    bool               functional         = options.functional;
+    unsigned int       jobs               = options.jobs;
 
     cerr << "\e[1;34mPreparing experiment...\e[0m\n";
 
-    // Start embedded python
-    PythonWrapper &pythonwrapper = PythonWrapper::GetInstance();
-
     // Open Experiment
-    std::string experimentpath;
-    experimentpath  = "./experiments/";
-    experimentpath += experimentname;
-    experimentpath += ".xml";
     Experiment experiment(experimentpath);
 
     // Setup models
     Monitor monitor;
+    ARBITRATIONPOLICY arbitration     = ARBITRATIONPOLICY::NONE;
+    sc_core::sc_time  arbitrationslot = sc_core::SC_ZERO_TIME;
 
     try
     {
@@ -233,6 +222,27 @@ int sc_main(int argc, char *argv[])
         std::cerr << "\e[1;33mLoading model selection from XML file failed. Using settings from command line instead.\n";
     }
 
+    // A typo in these attributes would silently simulate a different model
+    try
+    {
+        std::tie(arbitration, arbitrationslot) = experiment.LoadArbitrationPolicy();
+    }
+    catch(const std::runtime_error &e)
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Loading the bus arbitration policy from " << experimentpath << " failed!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    try
+    {
+        DelayVector::SetParametricFamily(experiment.LoadParametricFamily());
+    }
+    catch(const std::runtime_error &e)
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Loading the distribution family from " << experimentpath << " failed!\n";
+        exit(EXIT_FAILURE);
+    }
+
     if(communicationmodel == COMMUNICATIONMODEL::MESSAGELEVEL)
     {
         readdelay  = sc_core::SC_ZERO_TIME;
@@ -246,7 +256,7 @@ int sc_main(int argc, char *argv[])
     if(communicationmodel == COMMUNICATIONMODEL::CYCLEACCURATE
     or communicationmodel == COMMUNICATIONMODEL::SYSTEMCEVENTS)
     {
-        bus = new AXIInterconnect("AXIBus");
+        bus = new AXIInterconnect("AXIBus", arbitration, arbitrationslot);
     }
     else if(communicationmodel == COMMUNICATIONMODEL::MESSAGELEVEL)
     {
@@ -259,18 +269,105 @@ int sc_main(int argc, char *argv[])
         std::cerr << " \e[1;30m(functional)";
     else
         std::cerr << " \e[1;30m(non-functional)";
-    if(skipsamples > 0)
-        std::cerr << " \e[0;36mskipping first " << skipsamples << " samples";
+    if(options.skipsamples > 0)
+        std::cerr << " \e[0;36mskipping first " << options.skipsamples << " samples";
     std::cerr << "\n";
     std::cerr << "\e[1;36mCommunication Model: \e[1;37m" << communicationmodel << "\n";
     std::cerr << "\e[1;36mShared Memory:       \e[1;37mread = " << readdelay << "\e[1;30m;\e[1;37m write = " << writedelay << "\n";
-    std::cerr << "\e[1;36mInterconnect:        \e[1;37mFCFS\n";
+    std::cerr << "\e[1;36mInterconnect:        \e[1;37m";
+    if(communicationmodel == COMMUNICATIONMODEL::MESSAGELEVEL)
+        std::cerr << "FCFS\n";
+    else
+    {
+        switch(arbitration)
+        {
+            case ARBITRATIONPOLICY::NONE:          std::cerr << "AXI (contention penalties)\n"; break;
+            case ARBITRATIONPOLICY::FCFS:          std::cerr << "AXI (FCFS)\n";           break;
+            case ARBITRATIONPOLICY::ROUNDROBIN:    std::cerr << "AXI (round robin)\n";    break;
+            case ARBITRATIONPOLICY::FIXEDPRIORITY: std::cerr << "AXI (fixed priority)\n"; break;
+            case ARBITRATIONPOLICY::TDMA:          std::cerr << "AXI (TDMA, slot = " << arbitrationslot << ")\n"; break;
+        }
+    }
 
 
     // Create Actors
     monitor.EnableAppOutput(functional);
     monitor.EnableDurationOutput(!functional);
-    monitor.EnableTraceOutput(tracepath);
+    monitor.EnableTraceOutput(options.tracepath);
+
+    // A trace can not be continued
+    uint64_t checkpointinterval = options.checkpointinterval;
+    bool     resume             = options.resume;
+    if((checkpointinterval > 0 or resume) and options.tracepath != nullptr)
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Traced simulations can not be checkpointed or resumed. \e[1;30m(Simulating from the beginning without checkpoints)\e[0m\n";
+        checkpointinterval = 0;
+        resume             = false;
+    }
+    bool checkpoints = checkpointinterval > 0 or resume;
+
+    // All tiles wait for each other at a checkpoint. This drains the pipeline,
+    // so the iteration durations would differ from a simulation without checkpoints.
+    if(checkpoints and not functional)
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Checkpoints are only supported for the functional model! "
+                  << "\e[1;30m(They would change the iteration durations)\e[0m\n";
+        exit(EXIT_FAILURE);
+    }
+
+    std::string checkpointpath = experimentname + ".checkpoint";
+    if(options.checkpointpath != nullptr)
+        checkpointpath = options.checkpointpath;
+    else if(options.outputpath != nullptr)
+        checkpointpath = std::string(options.outputpath) + ".checkpoint";
+
+    // When resuming, the sinks keep the samples of the previous run
+    std::unique_ptr<SampleSink> samplesink;
+    if(options.binarysink)
+    {
+        if(options.outputpath == nullptr)
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m The binary sink requires an output file (--output)!\n";
+            exit(EXIT_FAILURE);
+        }
+        samplesink.reset(new BinarySampleSink(options.outputpath, experimentname, options.seed, options.skipsamples, resume));
+    }
+    else
+        samplesink.reset(new TextSampleSink(options.outputpath, resume));
+    monitor.SetSampleSink(samplesink.get());
+
+    // With constant delays, the simulation becomes periodic after a transient phase
+    bool perioddetection = options.extrapolate and not functional and not options.datadependentdelay
+                       and (distribution == DISTRIBUTION::AVERAGE or distribution == DISTRIBUTION::WCET);
+    if(perioddetection)
+        monitor.EnablePeriodDetection(options.maxiterations);
+
+    // With a target precision, the iterations are only the upper limit
+    std::unique_ptr<StoppingRule> stoppingrule;
+    if(options.precision > 0.0 and not functional)
+    {
+        stoppingrule.reset(new StoppingRule(options.precision, options.precisionquantiles, options.confidence));
+        monitor.SetStoppingRule(stoppingrule.get());
+    }
+
+    // The output of the application and the trace can not be split into shards
+    if(jobs > 1 and (functional or options.tracepath != nullptr))
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Functional and traced simulations can not be split. \e[1;30m(Using one process)\e[0m\n";
+        jobs = 1;
+    }
+    // The length of the shards must be known before the simulation starts
+    if(jobs > 1 and stoppingrule)
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Simulations with a target precision can not be split. \e[1;30m(Using one process)\e[0m\n";
+        jobs = 1;
+    }
+    // All tiles take part in a checkpoint
+    if(jobs > 1 and checkpoints)
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Simulations with checkpoints can not be split. \e[1;30m(Using one process)\e[0m\n";
+        jobs = 1;
+    }
 
     // Create Channels
     // name, producerate, consumerate, size
@@ -295,79 +392,59 @@ int sc_main(int argc, char *argv[])
     Channel ch_cb      ("cb",       64, 64, 64, monitor, communicationmodel);
 
     // Create Delay Vectors
-    // Sobel2 Timings
-#define SOBEL2_DelayVector(a) DelayVector(sobel2directory + a , distribution, skipsamples)
-    std::string sobel2directory = "../PlatformV2/timings/sobel2/bram/";
-    DelayVectorMap getpixel2_delay;
-    DelayVectorMap gx2_delay;
-    DelayVectorMap gy2_delay;
-    DelayVectorMap abs2_delay;
-
-    getpixel2_delay["none"] = new SOBEL2_DelayVector("GetPixel.txt");
-    getpixel2_delay["ea"]   = new SOBEL2_DelayVector("GetPixel-ea.txt");
-    getpixel2_delay["ef"]   = new SOBEL2_DelayVector("GetPixel-ef.txt");
-    gx2_delay["none"]       = new SOBEL2_DelayVector("GX.txt");
-    gx2_delay["ea"]         = new SOBEL2_DelayVector("GX-ea.txt");
-    gx2_delay["ef"]         = new SOBEL2_DelayVector("GX-ef.txt");
-    gy2_delay["none"]       = new SOBEL2_DelayVector("GY.txt");
-    gy2_delay["ea"]         = new SOBEL2_DelayVector("GY-ea.txt");
-    gy2_delay["ef"]         = new SOBEL2_DelayVector("GY-ef.txt");
-    abs2_delay["none"]      = new SOBEL2_DelayVector("ABS.txt");
-    abs2_delay["ea"]        = new SOBEL2_DelayVector("ABS-ea.txt");
-    abs2_delay["ef"]        = new SOBEL2_DelayVector("ABS-ef.txt");
-#undef SOBEL2_DelayVector
-
-    // JPEG Timings
-#define JPEG_DelayVector(a) DelayVector(jpegdirectory + a , distribution, skipsamples)
-    std::string jpegdirectory = "../PlatformV2/timings/jpeg/bram/";
-    DelayVectorMap getencodedimageblock_delay;
-    DelayVectorMap iq_y_delay;
-    DelayVectorMap iq_cr_delay;
-    DelayVectorMap iq_cb_delay;
-    DelayVectorMap idct_y_delay;
-    DelayVectorMap idct_cr_delay;
-    DelayVectorMap idct_cb_delay;
-    DelayVectorMap creatergbpixels_delay;
-
-    getencodedimageblock_delay["none"] = new JPEG_DelayVector("GetEncodedImageBlock.txt");
-    getencodedimageblock_delay["ea"]   = new JPEG_DelayVector("GetEncodedImageBlock-ea.txt");
-    getencodedimageblock_delay["ef"]   = new JPEG_DelayVector("GetEncodedImageBlock-ef.txt");
-
-    iq_y_delay["none"]                 = new JPEG_DelayVector("InverseQuantization_Y.txt");
-    iq_y_delay["ea"]                   = new JPEG_DelayVector("InverseQuantization_Y-ea.txt");
-    iq_y_delay["ef"]                   = new JPEG_DelayVector("InverseQuantization_Y-ef.txt");
-    iq_cr_delay["none"]                = new JPEG_DelayVector("InverseQuantization_Cr.txt");
-    iq_cr_delay["ea"]                  = new JPEG_DelayVector("InverseQuantization_Cr-ea.txt");
-    iq_cr_delay["ef"]                  = new JPEG_DelayVector("InverseQuantization_Cr-ef.txt");
-    iq_cb_delay["none"]                = new JPEG_DelayVector("InverseQuantization_Cb.txt");
-    iq_cb_delay["ea"]                  = new JPEG_DelayVector("InverseQuantization_Cb-ea.txt");
-    iq_cb_delay["ef"]                  = new JPEG_DelayVector("InverseQuantization_Cb-ef.txt");
-
-    idct_y_delay["none"]               = new JPEG_DelayVector("IDCT_Y.txt");
-    idct_y_delay["ea"]                 = new JPEG_DelayVector("IDCT_Y-ea.txt");
-    idct_y_delay["ef"]                 = new JPEG_DelayVector("IDCT_Y-ef.txt");
-    idct_cr_delay["none"]              = new JPEG_DelayVector("IDCT_Cr.txt");
-    idct_cr_delay["ea"]                = new JPEG_DelayVector("IDCT_Cr-ea.txt");
-    idct_cr_delay["ef"]                = new JPEG_DelayVector("IDCT_Cr-ef.txt");
-    idct_cb_delay["none"]              = new JPEG_DelayVector("IDCT_Cb.txt");
-    idct_cb_delay["ea"]                = new JPEG_DelayVector("IDCT_Cb-ea.txt");
-    idct_cb_delay["ef"]                = new JPEG_DelayVector("IDCT_Cb-ef.txt");
-
-    creatergbpixels_delay["none"]      = new JPEG_DelayVector("CreateRGBPixels.txt");
-    creatergbpixels_delay["ea"]        = new JPEG_DelayVector("CreateRGBPixels-ea.txt");
-    creatergbpixels_delay["ef"]        = new JPEG_DelayVector("CreateRGBPixels-ef.txt");
-#undef JPEG_DelayVector
+    // They get loaded after the actor mapping is known.
+    ActorDelayVectors actordelays = CreateDelayVectors(delayvectors, distribution, options.skipsamples);
+
+    // Sobel2 data dependent delays (-d explicit)
+#define SOBEL2_DelayTable(a) DelayTable(sobel2tabledirectory + a)
+    std::string sobel2tabledirectory = "../PlatformV2/timings/sobel2/datadependent/";
+    DelayTableMap getpixel2_table;
+    DelayTableMap gx2_table;
+    DelayTableMap gy2_table;
+    DelayTableMap abs2_table;
+
+    getpixel2_table["none"] = new SOBEL2_DelayTable("GetPixel.txt");
+    getpixel2_table["ea"]   = new SOBEL2_DelayTable("GetPixel-ea.txt");
+    getpixel2_table["ef"]   = new SOBEL2_DelayTable("GetPixel-ef.txt");
+    gx2_table["none"]       = new SOBEL2_DelayTable("GX.txt");
+    gx2_table["ea"]         = new SOBEL2_DelayTable("GX-ea.txt");
+    gx2_table["ef"]         = new SOBEL2_DelayTable("GX-ef.txt");
+    gy2_table["none"]       = new SOBEL2_DelayTable("GY.txt");
+    gy2_table["ea"]         = new SOBEL2_DelayTable("GY-ea.txt");
+    gy2_table["ef"]         = new SOBEL2_DelayTable("GY-ef.txt");
+    abs2_table["none"]      = new SOBEL2_DelayTable("ABS.txt");
+    abs2_table["ea"]        = new SOBEL2_DelayTable("ABS-ea.txt");
+    abs2_table["ef"]        = new SOBEL2_DelayTable("ABS-ef.txt");
+#undef SOBEL2_DelayTable
 
 
 
     // Create Architecture Components
-    Tile mb0("MB0", maxiterations, monitor);
-    Tile mb1("MB1", maxiterations, monitor);
-    Tile mb2("MB2", maxiterations, monitor);
-    Tile mb3("MB3", maxiterations, monitor);
-    Tile mb4("MB4", maxiterations, monitor);
-    Tile mb5("MB5", maxiterations, monitor);
-    Tile mb6("MB6", maxiterations, monitor);
+    Tile mb0("MB0", options.maxiterations, monitor);
+    Tile mb1("MB1", options.maxiterations, monitor);
+    Tile mb2("MB2", options.maxiterations, monitor);
+    Tile mb3("MB3", options.maxiterations, monitor);
+    Tile mb4("MB4", options.maxiterations, monitor);
+    Tile mb5("MB5", options.maxiterations, monitor);
+    Tile mb6("MB6", options.maxiterations, monitor);
+
+    if(options.quantum > 0)
+    {
+        tlm_utils::tlm_quantumkeeper::set_global_quantum(sc_core::sc_time(options.quantum, sc_core::SC_NS));
+        for(Tile *tile : {&mb0, &mb1, &mb2, &mb3, &mb4, &mb5, &mb6})
+            tile->EnableTemporalDecoupling();
+    }
+
+    // Without per-word arbitration the tiles can access the shared memory directly.
+    // DMI bypasses the trace and the hooks the polling fast-forward relies on, so the shared memory refuses it then.
+    if(monitor.IsTraceEnabled() or (options.fastforward and communicationmodel == COMMUNICATIONMODEL::CYCLEACCURATE))
+        sharedmemory.DisableDMI();
+    if(communicationmodel == COMMUNICATIONMODEL::MESSAGELEVEL or functional)
+    {
+        std::cerr << "\e[1;34mUsing DMI for shared memory accesses\e[0m\n";
+        for(Tile *tile : {&mb0, &mb1, &mb2, &mb3, &mb4, &mb5, &mb6})
+            tile->EnableDMI();
+    }
 
 
     // Create & Load Actors
@@ -386,20 +463,28 @@ int sc_main(int argc, char *argv[])
 
 
     // Type          Name       Name        Delay Vector     Monitor  Application
-    Sobel2::GetPixel getpixel2("GetPixel2", getpixel2_delay, monitor, application, datadependentdelay);
-    Sobel2::GX       gx2      ("GX2"      , gx2_delay      , monitor, application, datadependentdelay);
-    Sobel2::GY       gy2      ("GY2"      , gy2_delay      , monitor, application, datadependentdelay);
-    Sobel2::ABS      abs2     ("ABS2"     , abs2_delay     , monitor, application, datadependentdelay);
+    Sobel2::GetPixel getpixel2("GetPixel2", actordelays["GetPixel2"], monitor, application);
+    Sobel2::GX       gx2      ("GX2"      , actordelays["GX2"]      , monitor, application);
+    Sobel2::GY       gy2      ("GY2"      , actordelays["GY2"]      , monitor, application);
+    Sobel2::ABS      abs2     ("ABS2"     , actordelays["ABS2"]     , monitor, application);
+
+    if(options.datadependentdelay)
+    {
+        getpixel2.UseDelayTables(getpixel2_table);
+        gx2      .UseDelayTables(gx2_table);
+        gy2      .UseDelayTables(gy2_table);
+        abs2     .UseDelayTables(abs2_table);
+    }
 
     // Type              Name                   Name                  Delay Vector                Monitor
-    JPEG::GetEncodedImageBlock getencodedimageblock("GetEncodedImageBlock", getencodedimageblock_delay, monitor, application);
-    JPEG::IQ_Y                 iq_y                ("IQ_Y"                , iq_y_delay                , monitor, application);
-    JPEG::IQ_Cr                iq_cr               ("IQ_Cr"               , iq_cr_delay               , monitor, application);
-    JPEG::IQ_Cb                iq_cb               ("IQ_Cb"               , iq_cb_delay               , monitor, application);
-    JPEG::IDCT_Y               idct_y              ("IDCT_Y"              , idct_y_delay              , monitor, application);
-    JPEG::IDCT_Cr              idct_cr             ("IDCT_Cr"             , idct_cr_delay             , monitor, application);
-    JPEG::IDCT_Cb              idct_cb             ("IDCT_Cb"             , idct_cb_delay             , monitor, application);
-    JPEG::CreateRGBPixels      creatergbpixels     ("CreatetRGBPixels"    , creatergbpixels_delay     , monitor, application);
+    JPEG::GetEncodedImageBlock getencodedimageblock("GetEncodedImageBlock", actordelays["GetEncodedImageBlock"], monitor, application);
+    JPEG::IQ_Y                 iq_y                ("IQ_Y"                , actordelays["IQ_Y"]                , monitor, application);
+    JPEG::IQ_Cr                iq_cr               ("IQ_Cr"               , actordelays["IQ_Cr"]               , monitor, application);
+    JPEG::IQ_Cb                iq_cb               ("IQ_Cb"               , actordelays["IQ_Cb"]               , monitor, application);
+    JPEG::IDCT_Y               idct_y              ("IDCT_Y"              , actordelays["IDCT_Y"]              , monitor, application);
+    JPEG::IDCT_Cr              idct_cr             ("IDCT_Cr"             , actordelays["IDCT_Cr"]             , monitor, application);
+    JPEG::IDCT_Cb              idct_cb             ("IDCT_Cb"             , actordelays["IDCT_Cb"]             , monitor, application);
+    JPEG::CreateRGBPixels      creatergbpixels     ("CreatetRGBPixels"    , actordelays["CreateRGBPixels"]     , monitor, application);
 
     // Define start and finish actors
     getpixel2.DefineAsStartActor();
@@ -452,6 +537,13 @@ int sc_main(int argc, char *argv[])
     MemoryMap memorymap;
     memorymap["SharedMemory"] = &sharedmemory;
 
+    // Only the cycle accurate model simulates each polling round
+    if(options.fastforward and communicationmodel == COMMUNICATIONMODEL::CYCLEACCURATE)
+    {
+        for(auto &channel : channelmap)
+            channel.second->EnablePollingFastForward();
+    }
+
 
     // Load mappings
     success = experiment.LoadActorMapping(tilemap, actormap);
@@ -472,6 +564,22 @@ int sc_main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    // The start actor can be ahead of the finish actor by at most
+    // as many iterations as the channel buffers can hold, plus one per actor.
+    size_t inflightiterations = actormap.size();
+    for(auto &channel : channelmap)
+        inflightiterations += channel.second->fifosize / channel.second->producerate + 1;
+    monitor.SetIterationCapacity(inflightiterations);
+
+    // Load the delay vectors of all mapped actors before the simulation starts
+    std::vector<DelayVector*> requireddelayvectors;
+    for(auto &actor : actormap)
+    {
+        if(actor.second->IsMapped())
+            requireddelayvectors.push_back(actor.second->GetDelayVector());
+    }
+    delayvectors.Preload(requireddelayvectors);
+
 
     // Connection of actors
     getpixel2 << ch_pos;
@@ -520,19 +628,625 @@ int sc_main(int argc, char *argv[])
     *bus << sharedmemory;
 
 
+    // Checkpoints
+    // Everything that influences the simulation must be the same when resuming
+    std::unique_ptr<Checkpoint> checkpoint;
+    if(checkpoints)
+    {
+        std::ostringstream configuration;
+        configuration << "experiment="     << experimentname
+                      << " distribution="  << distribution
+                      << " family="        << DelayVector::GetParametricFamily()
+                      << " datadependent=" << options.datadependentdelay
+                      << " functional="    << functional
+                      << " communication=" << communicationmodel
+                      << " arbitration="   << arbitration << "/" << arbitrationslot
+                      << " quantum="       << options.quantum
+                      << " fastforward="   << options.fastforward
+                      << " seed="          << options.seed
+                      << " skip="          << options.skipsamples
+                      << " iterations="    << options.maxiterations
+                      << " extrapolate="   << perioddetection;
+        if(stoppingrule)
+        {
+            configuration << " precision=" << options.precision << " confidence=" << options.confidence;
+            for(double quantile : options.precisionquantiles)
+                configuration << " quantile=" << quantile;
+        }
+
+        checkpoint.reset(new Checkpoint(checkpointpath, checkpointinterval, configuration.str(),
+                                        monitor, delayvectors, application, *bus));
+        for(Tile *tile : {&mb0, &mb1, &mb2, &mb3, &mb4, &mb5, &mb6})
+            *checkpoint << *tile;
+        *checkpoint << sharedmemory;
+        for(auto &channel : channelmap)
+            *checkpoint << *channel.second;
+        for(auto &actor : actormap)
+            *checkpoint << *actor.second;
+
+        if(resume)
+        {
+            try
+            {
+                checkpoint->Load();
+            }
+            catch(const std::runtime_error &e)
+            {
+                std::cerr << "\e[1;31mERROR:\e[0m Resuming experiment " << experimentname << " failed - " << e.what() << "\n";
+                exit(EXIT_FAILURE);
+            }
+        }
+        if(checkpoint->GetInterval() > 0)
+            std::cerr << "\e[1;34mWriting a checkpoint every " << checkpoint->GetInterval()
+                      << " iterations into " << checkpointpath << "\e[0m\n";
+    }
+
+
+    // Interrupted while setting up, nothing got simulated
+    if(Interruption::IsRequested())
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Interrupted before the simulation started\n";
+        delete bus;
+        if(PythonWrapper::IsStarted())
+            PythonWrapper::GetInstance().ForceShutdown();
+        return Interruption::GetExitStatus();
+    }
+
+
     // Start simulation
-    std::cerr << "\e[1;37mSimulation started\n\e[0m";
-    sc_core::sc_start();
+    // After an interrupt signal, the samples and statistics of the completed iterations get written as usual
+    bool interrupted = false;
+    std::unique_ptr<ParallelRun> parallelrun;
+    if(jobs > 1)
+    {
+        parallelrun.reset(new ParallelRun(jobs, options.skipsamples, options.maxiterations, options.warmup));
+        const Shard *shard = parallelrun->Fork();
+        if(shard != nullptr)
+        {
+            // Worker: Simulate the own shard into the own sample file.
+            // It leaves with _exit, so only the parent cleans up the shared resources.
+            delayvectors.Seek(shard->first - shard->warmup);
+            for(auto &tile : tilemap)
+                tile.second->SetMaxIterations(shard->warmup + shard->count);
+            monitor.SetWarmup(shard->warmup);
+            if(perioddetection)
+                monitor.EnablePeriodDetection(shard->warmup + shard->count);
+
+            BinarySampleSink shardsink(shard->path.c_str(), experimentname, options.seed, shard->first);
+            monitor.SetSampleSink(&shardsink);
+            sc_core::sc_start();
+            shardsink.Close();
+            _exit(EXIT_SUCCESS);
+        }
+
+        bool success = parallelrun->Wait();
+        interrupted  = Interruption::IsRequested();
+        success      = (success or interrupted)
+                   and parallelrun->Merge(*samplesink, monitor.GetStatistics(), interrupted);
+        samplesink->Close();
+        parallelrun.reset();    // Removes the sample files of the workers
+        if(not success)
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m Parallel simulation failed!\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+    else
+    {
+        std::cerr << "\e[1;37mSimulation started\n\e[0m";
+        sc_core::sc_start();
+
+        interrupted = monitor.IsInterrupted();
+        samplesink->Close();
+
+        // A complete simulation does not need to be resumed.
+        // An interrupted one can be continued from its last checkpoint.
+        if(checkpoint and not interrupted)
+            checkpoint->Remove();
+
+        if(stoppingrule)
+        {
+            stoppingrule->Finish();
+            stoppingrule->WriteReport(std::cerr);
+        }
+    }
+
+    if(interrupted)
+        std::cerr << "\e[1;33mSimulation interrupted after " << monitor.GetStatistics().GetCount() << " recorded iterations\n\e[0m";
+    else
+        std::cerr << "\e[1;37mSimulation ended\n\e[0m";
+
+    if(not functional)
+    {
+        std::ofstream summaryfile;
+        if(options.summarypath != nullptr)
+            summaryfile.open(options.summarypath);
+
+        if(summaryfile.is_open())
+            monitor.GetStatistics().WriteSummary(summaryfile, experimentname, interrupted);
+        else
+        {
+            if(options.summarypath != nullptr)
+                std::cerr << "\e[1;31mERROR:\e[0m Opening " << options.summarypath << " failed! \e[1;30m(Writing summary to stderr instead)\n";
+            monitor.GetStatistics().WriteSummary(std::cerr, experimentname, interrupted);
+        }
+    }
 
-    std::cerr << "\e[1;37mSimulation ended\n\e[0m";
+    AXIInterconnect *axibus = dynamic_cast<AXIInterconnect*>(bus);
+    if(axibus != nullptr and axibus->GetFastForwardedPolls() > 0)
+        std::cerr << "\e[1;30mFast-forwarded polling rounds: " << axibus->GetFastForwardedPolls() << "\e[0m\n";
 
     delete bus;
 
-    pythonwrapper.ForceShutdown();
-    Python &python = Python::GetInstance();
-    python.ForceShutdown();
+    if(PythonWrapper::IsStarted())
+        PythonWrapper::GetInstance().ForceShutdown();
 
-    return 0;
+    return interrupted ? Interruption::GetExitStatus() : 0;
 }
-// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
 
+
+
+// Runs all experiments that match the patterns, each in its own process (see experimentsweep.hpp).
+// The applications and the delay vectors of all experiments get loaded once before.
+// The results get written into the directory given by --output (default: the current directory):
+// <experiment>.txt/.bin, <experiment>.json, <experiment>.log and the timing of all experiments in sweep.json.
+int RunSweep(const std::vector<std::string> &patterns, unsigned int limit,
+             const SimulationOptions &options, DelayVectorRegistry &delayvectors)
+{
+    ExperimentSweep sweep(patterns);
+    if(sweep.GetExperiments().empty())
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m No experiments selected for the sweep!\n";
+        return EXIT_FAILURE;
+    }
+
+    std::string outputdirectory = options.outputpath != nullptr ? options.outputpath : ".";
+    if(mkdir(outputdirectory.c_str(), 0755) != 0 and errno != EEXIST)
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Creating output directory " << outputdirectory << " failed - " << strerror(errno) << "\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cerr << "\e[1;34mPreparing " << sweep.GetExperiments().size() << " experiments...\e[0m\n";
+
+    // The shared objects stay loaded, so dlopen in the experiment's process just finds them
+    std::vector<std::unique_ptr<SDFApplication>> applications;
+    std::vector<DelayVector*> requireddelayvectors;
+    for(const SweepExperiment &entry : sweep.GetExperiments())
+    {
+        std::string  experimentpath = entry.path;
+        Experiment   experiment(experimentpath);
+        DISTRIBUTION distribution   = options.distribution;
+        // Errors get reported by the experiment's own process
+        try
+        {
+            std::tie(distribution, std::ignore, std::ignore) = experiment.LoadModels();
+        }
+        catch(const std::runtime_error &e)
+        {
+        }
+        try
+        {
+            DelayVector::SetParametricFamily(experiment.LoadParametricFamily());
+        }
+        catch(const std::runtime_error &e)
+        {
+            DelayVector::SetParametricFamily(FAMILY::AUTOMATIC);
+        }
+
+        applications.emplace_back(new SDFApplication());
+        experiment.LoadApplication(applications.back().get());
+
+        if(options.datadependentdelay)
+            continue;
+
+        ActorDelayVectors actordelays = CreateDelayVectors(delayvectors, distribution, options.skipsamples);
+        for(const auto &actorfeature : experiment.LoadActorFeatures())
+        {
+            auto actor = actordelays.find(actorfeature.first);
+            if(actor == actordelays.end())
+                continue;
+            auto delayvector = actor->second.find(actorfeature.second);
+            if(delayvector != actor->second.end())
+                requireddelayvectors.push_back(delayvector->second);
+        }
+    }
+    DelayVector::SetParametricFamily(FAMILY::AUTOMATIC);
+    delayvectors.Preload(requireddelayvectors);
+
+    size_t failed = sweep.Run(limit, outputdirectory, [&options, &outputdirectory, &delayvectors](const SweepExperiment &entry)
+    {
+        std::string outputpath  = outputdirectory + "/" + entry.name + (options.binarysink ? ".bin" : ".txt");
+        std::string summarypath = outputdirectory + "/" + entry.name + ".json";
+
+        std::string checkpointpath = outputdirectory + "/" + entry.name + ".checkpoint";
+
+        // When resuming a sweep, the experiments without checkpoint start from the beginning
+        SimulationOptions experimentoptions = options;
+        experimentoptions.outputpath     = outputpath.c_str();
+        experimentoptions.summarypath    = summarypath.c_str();
+        experimentoptions.checkpointpath = checkpointpath.c_str();
+        experimentoptions.resume         = options.resume and access(checkpointpath.c_str(), F_OK) == 0;
+        return RunExperiment(entry.path, entry.name, experimentoptions, delayvectors);
+    });
+
+    std::string   timingpath = outputdirectory + "/sweep.json";
+    std::ofstream timingfile(timingpath);
+    if(timingfile.is_open())
+        sweep.WriteTimings(timingfile);
+    else
+        std::cerr << "\e[1;31mERROR:\e[0m Writing " << timingpath << " failed!\n";
+
+    std::cerr << "\e[1;37m" << sweep.GetExperiments().size() - failed << " of " << sweep.GetExperiments().size()
+              << " experiments finished successfully\e[0m\n";
+    if(Interruption::IsRequested())
+        return Interruption::GetExitStatus();
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+
+int sc_main(int argc, char *argv[])
+{
+    // Read command line parameters
+    SimulationOptions        options;
+    std::vector<std::string> sweeppatterns;
+    unsigned int             sweepjobs = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for(int i=0; i<argc; i++)
+    {
+        if((strncmp("--help", argv[i], 20) == 0) || (strncmp("-h", argv[i], 20) == 0))
+        {
+            PrintUsage();
+            exit(EXIT_SUCCESS);
+        }
+        if((strncmp("--iterations", argv[i], 20) == 0) || (strncmp("-i", argv[i], 20) == 0))
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --iteration. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.maxiterations = stoull(std::string(argv[i]));
+            cerr << "\e[1;33mLimiting iterations to " << options.maxiterations << "\e[0m\n";
+        }
+        if((strncmp("--skip", argv[i], 20) == 0) || (strncmp("-s", argv[i], 20) == 0))
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --skip. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.skipsamples = stoull(std::string(argv[i]));
+            cerr << "\e[1;33mSkipping " << options.skipsamples << " samples\e[0m\n";
+        }
+        if(strncmp("--seed", argv[i], 20) == 0)
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --seed. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.seed = stoull(std::string(argv[i]));
+            cerr << "\e[1;33mUsing seed " << options.seed << "\e[0m\n";
+        }
+        if((strncmp("--experiment", argv[i], 20) == 0) || (strncmp("-e", argv[i], 20) == 0))
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --experiment. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.experimentname = std::string(argv[i]);
+            cerr << "\e[1;37mRunning experiment " << options.experimentname << "\e[0m\n";
+        }
+        if((strncmp("--functional", argv[i], 20) == 0) || (strncmp("-f", argv[i], 20) == 0))
+        {
+            std::cerr << "\e[1;31mDEPRECATED: \e[0mUse attribute inside the XML file that describes the experiment!\n";
+            options.functional = true;
+            cerr << "\e[1;33mRunning functional test\e[0m\n";
+        }
+        if((strncmp("--communicationmodel", argv[i], 20) == 0) || (strncmp("-c", argv[i], 20) == 0))
+        {
+            std::cerr << "\e[1;31mDEPRECATED: \e[0mUse the XML file that describes the experiment!\n";
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --communicationmodel. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+
+            auto modelname = std::string(argv[i]);
+            
+            if(modelname == "cycleaccurate")
+                options.communicationmodel = COMMUNICATIONMODEL::CYCLEACCURATE;
+            else if(modelname == "systemcevents")
+                options.communicationmodel = COMMUNICATIONMODEL::SYSTEMCEVENTS;
+            else
+            {
+                cerr << "\e[1;31mERROR\e[0m Communication Model " << modelname << " not known.\e[0m\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+
+            cerr << "\e[1;34mUsing communication model " << modelname << "\e[0m\n";
+        }
+        if((strncmp("--distribution", argv[i], 20) == 0) || (strncmp("-d", argv[i], 20) == 0))
+        {
+            std::cerr << "\e[1;31mDEPRECATED: \e[0mUse the XML file that describes the experiment!\n";
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --distribution. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+
+            auto distributionname = std::string(argv[i]);
+            
+            if(distributionname == "injected")
+                options.distribution  = DISTRIBUTION::INJECTED;
+            else if(distributionname == "gaussian")
+                options.distribution  = DISTRIBUTION::GAUSSIAN;
+            else if(distributionname == "uniform")
+                options.distribution  = DISTRIBUTION::UNIFORM;
+            else if(distributionname == "wcet")
+                options.distribution  = DISTRIBUTION::WCET;
+            else if(distributionname == "gaussian_kde")
+                options.distribution  = DISTRIBUTION::GAUSSIAN_KDE;
+            else if(distributionname == "empirical")
+                options.distribution  = DISTRIBUTION::EMPIRICAL;
+            else if(distributionname == "empirical_kde")
+                options.distribution  = DISTRIBUTION::EMPIRICAL_KDE;
+            else if(distributionname == "parametric")
+                options.distribution  = DISTRIBUTION::PARAMETRIC;
+            else if(distributionname == "explicit")
+                options.datadependentdelay = true;
+            else
+            {
+                cerr << "\e[1;31mERROR\e[0m Distribution " << distributionname << " not known.\e[0m\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+
+            cerr << "\e[1;34mUsing distribution " << distributionname << "\e[0m\n";
+        }
+        if((strncmp("--trace", argv[i], 20) == 0) || (strncmp("-t", argv[i], 20) == 0))
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --trace. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+
+            options.tracepath = argv[i];
+            
+            cerr << "\e[1;34mWriting trace into " << options.tracepath << "\e[0m\n";
+        }
+        if((strncmp("--fastforward", argv[i], 20) == 0) || (strncmp("-p", argv[i], 20) == 0))
+        {
+            options.fastforward = true;
+            cerr << "\e[1;34mFast-forwarding polling rounds\e[0m\n";
+        }
+        if((strncmp("--quantum", argv[i], 20) == 0) || (strncmp("-q", argv[i], 20) == 0))
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --quantum. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.quantum = stol(std::string(argv[i]));
+            cerr << "\e[1;34mTemporal decoupling with a quantum of " << options.quantum << "ns\e[0m\n";
+        }
+        if((strncmp("--sink", argv[i], 20) == 0) || (strncmp("-k", argv[i], 20) == 0))
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --sink. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            if(strncmp("binary", argv[i], 20) == 0)
+                options.binarysink = true;
+            else if(strncmp("text", argv[i], 20) == 0)
+                options.binarysink = false;
+            else
+            {
+                cerr << "Invalid use of --sink. Valid arguments are text and binary!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+        }
+        if((strncmp("--output", argv[i], 20) == 0) || (strncmp("-o", argv[i], 20) == 0))
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --output. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.outputpath = argv[i];
+            cerr << "\e[1;34mWriting iteration durations into " << options.outputpath << "\e[0m\n";
+        }
+        if(strncmp("--summary", argv[i], 20) == 0)
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --summary. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.summarypath = argv[i];
+            cerr << "\e[1;34mWriting statistics summary into " << options.summarypath << "\e[0m\n";
+        }
+        if((strncmp("--exact", argv[i], 20) == 0) || (strncmp("-x", argv[i], 20) == 0))
+        {
+            options.extrapolate = false;
+        }
+        if(strncmp("--kde-crosscheck", argv[i], 20) == 0)
+        {
+            DelayVector::EnableKDECrossCheck();
+            cerr << "\e[1;34mCross-checking the native KDE with Python\e[0m\n";
+        }
+        if(strncmp("--no-cache", argv[i], 20) == 0)
+        {
+            DelayVector::EnableCache(false);
+        }
+        if(strncmp("--stream", argv[i], 20) == 0)
+        {
+            DelayVector::EnableStreaming();
+            cerr << "\e[1;34mStreaming injected delays from the timing files\e[0m\n";
+        }
+        if(strncmp("--stream-shuffle", argv[i], 20) == 0)
+        {
+            DelayVector::EnableStreaming();
+            DelayVector::EnableStreamShuffle();
+            cerr << "\e[1;34mStreaming injected delays from the timing files, shuffled in blocks\e[0m\n";
+        }
+        if(strncmp("--jobs", argv[i], 20) == 0)
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --jobs. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.jobs = std::max(stoul(std::string(argv[i])), 1ul);
+            cerr << "\e[1;34mUsing " << options.jobs << " worker processes\e[0m\n";
+        }
+        if(strncmp("--warmup", argv[i], 20) == 0)
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --warmup. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.warmup = stoull(std::string(argv[i]));
+            cerr << "\e[1;34mDiscarding " << options.warmup << " warm-up iterations per worker\e[0m\n";
+        }
+        if(strncmp("--precision", argv[i], 20) == 0)
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --precision. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.precision = stod(std::string(argv[i]));
+            cerr << "\e[1;34mSimulating until the relative precision is " << options.precision << "\e[0m\n";
+        }
+        if(strncmp("--precision-quantile", argv[i], 20) == 0)
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --precision-quantile. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            double quantile = stod(std::string(argv[i]));
+            if(quantile <= 0.0 or quantile >= 1.0)
+            {
+                cerr << "Invalid use of --precision-quantile. The quantile must be between 0 and 1!\n";
+                exit(EXIT_FAILURE);
+            }
+            options.precisionquantiles.push_back(quantile);
+        }
+        if(strncmp("--confidence", argv[i], 20) == 0)
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --confidence. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.confidence = stod(std::string(argv[i]));
+            if(options.confidence <= 0.0 or options.confidence >= 1.0)
+            {
+                cerr << "Invalid use of --confidence. The confidence level must be between 0 and 1!\n";
+                exit(EXIT_FAILURE);
+            }
+        }
+        if(strncmp("--checkpoint", argv[i], 20) == 0)
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --checkpoint. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.checkpointinterval = stoull(std::string(argv[i]));
+        }
+        if(strncmp("--checkpoint-file", argv[i], 20) == 0)
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --checkpoint-file. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            options.checkpointpath = argv[i];
+        }
+        if(strncmp("--resume", argv[i], 20) == 0)
+        {
+            options.resume = true;
+        }
+        if(strncmp("--sweep", argv[i], 20) == 0)
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --sweep. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            sweeppatterns.push_back(argv[i]);
+        }
+        if(strncmp("--sweep-jobs", argv[i], 20) == 0)
+        {
+            i++;
+            if(i >= argc)
+            {
+                cerr << "Invalid use of --sweep-jobs. Argument expected!\n";
+                PrintUsage();
+                exit(EXIT_FAILURE);
+            }
+            sweepjobs = std::max(stoul(std::string(argv[i])), 1ul);
+        }
+    }
+
+    DelayVector::SetSeed(options.seed);
+
+    Interruption::Install();
+
+    DelayVectorRegistry delayvectors;
+    if(not sweeppatterns.empty())
+        return RunSweep(sweeppatterns, sweepjobs, options, delayvectors);
+
+    std::string experimentpath = "./experiments/" + options.experimentname + ".xml";
+    return RunExperiment(experimentpath, options.experimentname, options, delayvectors);
+}
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
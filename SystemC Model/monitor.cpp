@@ -1,11 +1,39 @@
 #include <monitor.hpp>
+#include <stdexcept>
+#include <statestream.hpp>
+
+// Indexed by TRACEPHASE
+static const char* const TracePhaseNames[] =
+{
+    "IDLE", "R", "W", "ERROR",
+    "ACTIVE",
+    "read", "compute", "write", "idle",
+    "idle",
+    "R:init.", "R:polling", "R:prep.", "R:copying", "R:manag.", "R:idle",
+    "W:init.", "W:polling", "W:prep.", "W:copying", "W:manag.", "W:idle"
+};
 
 Monitor::Monitor()
-    : iterationstarted(0)
-    , iterationended(0)
-    , enableappoutput(false)
+    : enableappoutput(false)
     , enabledurationoutput(true)
     , enabletraceoutput(false)
+    , iterationstarted(0)
+    , iterationended(0)
+    , warmup(0)
+    , iterationstarts(64)
+    , iterationmask(63)
+    , defaultsink()
+    , samplesink(&defaultsink)
+    , stoppingrule(nullptr)
+    , precisionreached(false)
+    , interrupted(false)
+    , perioddetection(false)
+    , extrapolated(false)
+    , totaliterations(0)
+    , lastendtime(sc_core::SC_ZERO_TIME)
+    , durationhistory(HISTORYMASK + 1)
+    , gaphistory(HISTORYMASK + 1)
+    , periodmatches(MAXPERIOD + 1, 0)
 #ifdef ENABLE_EVD
     , evd()
 #endif
@@ -18,10 +46,22 @@ Monitor::~Monitor()
 
 
 
+void Monitor::SetWarmup(uint64_t iterations)
+{
+    this->warmup = iterations;
+}
 void Monitor::EnableDurationOutput(bool enable)
 {
     this->enabledurationoutput = enable;
 }
+void Monitor::SetSampleSink(SampleSink *sink)
+{
+    this->samplesink = sink;
+}
+OnlineStatistics& Monitor::GetStatistics()
+{
+    return this->statistics;
+}
 void Monitor::EnableAppOutput(bool enable)
 {
     this->enableappoutput = enable;
@@ -45,15 +85,36 @@ void Monitor::EnableTraceOutput(const char* tracepath)
 
 
 
-void Monitor::ExpandTrace(std::string signalname, std::string value)
+bool Monitor::IsTraceEnabled() const
+{
+    return this->enabletraceoutput;
+}
+
+
+
+TraceSignal Monitor::RegisterSignal(const std::string &signalname)
 {
-    if(this->enabletraceoutput)
+    for(TraceSignal signal = 0; signal < this->signalnames.size(); signal++)
     {
+        if(this->signalnames[signal] == signalname)
+            return signal;
+    }
+
+    this->signalnames.push_back(signalname);
+    return this->signalnames.size() - 1;
+}
+
+
+
+void Monitor::AddTraceEvent(TraceSignal signal, TRACEPHASE phase)
+{
 #ifdef ENABLE_EVD
-        sc_core::sc_time timestamp = sc_core::sc_time_stamp();
-        this->evd.AddEvent(signalname, timestamp.value()/1000, value);
+    sc_core::sc_time timestamp = sc_core::sc_time_stamp();
+    this->evd.AddEvent(this->signalnames[signal], timestamp.value()/1000, TracePhaseNames[phase]);
+#else
+    (void)signal;
+    (void)phase;
 #endif
-    }
 }
 
 
@@ -66,23 +127,53 @@ void Monitor::PrintAppOutput(std::string output)
 
 
 
+void Monitor::SetIterationCapacity(size_t inflight)
+{
+    size_t capacity = 1;
+    while(capacity < inflight)
+        capacity <<= 1;
+
+    // Keep the start times of iterations that are already in flight
+    std::vector<sc_core::sc_time> starts(capacity);
+    for(uint64_t iteration = this->iterationended + 1; iteration <= this->iterationstarted; iteration++)
+        starts[iteration & (capacity - 1)] = this->iterationstarts[iteration & this->iterationmask];
+
+    this->iterationstarts = std::move(starts);
+    this->iterationmask   = capacity - 1;
+}
+
+
+
 void Monitor::IterationBegin()
 {
     this->iterationstarted++;
-    this->iterationstarts.emplace(iterationstarted, sc_core::sc_time_stamp());
+
+    if(this->iterationstarted - this->iterationended > this->iterationstarts.size())
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m More than " << this->iterationstarts.size()
+                  << " iterations in flight. Doubling the capacity of the Monitor's iteration buffer.\n";
+        this->SetIterationCapacity(2 * this->iterationstarts.size());
+    }
+
+    this->iterationstarts[this->iterationstarted & this->iterationmask] = sc_core::sc_time_stamp();
 }
 
 
 
 void Monitor::IterationEnd()
 {
+    // After extrapolation, all samples are written already.
+    // After reaching the precision, the remaining iterations in flight do not count.
+    if(this->extrapolated or this->precisionreached)
+        return;
+
     // Get information about start time of the currently ended iteration
     this->iterationended++;
 
-    auto startinfos = this->iterationstarts.find(this->iterationended);
-    if(startinfos == this->iterationstarts.end())
+    if(this->iterationended > this->iterationstarted)
     {
         std::cerr << "\e[1;31mERROR: \e[0mCannot find start time stamp for a finished iteration.\n";
+        this->iterationended--;
         return;
     }
 
@@ -91,12 +182,186 @@ void Monitor::IterationEnd()
     sc_core::sc_time stoptime;
     sc_core::sc_time duration;
 
-    starttime = startinfos->second;
+    starttime = this->iterationstarts[this->iterationended & this->iterationmask];
     stoptime  = sc_core::sc_time_stamp();
     duration  = stoptime - starttime;
 
-    if(this->enabledurationoutput == true)
-        std::cout << std::dec << duration.value() / 1000 << "\n";
+    if(this->enabledurationoutput == true and this->iterationended > this->warmup)
+        this->AddSample(duration.value() / 1000);
+
+    if(this->perioddetection)
+        this->DetectPeriod(duration, stoptime);
+}
+
+
+
+void Monitor::AddSample(uint64_t duration)
+{
+    this->samplesink->Write(duration);
+    this->statistics.Add(duration);
+
+    if(this->stoppingrule != nullptr and this->stoppingrule->Add(duration))
+    {
+        this->precisionreached = true;
+        sc_core::sc_stop();
+    }
+}
+
+
+
+void Monitor::SetStoppingRule(StoppingRule *rule)
+{
+    this->stoppingrule = rule;
+}
+
+void Monitor::Interrupt()
+{
+    // Several tiles may notice the signal in the same delta cycle
+    if(this->HasStopped())
+        return;
+
+    this->interrupted = true;
+    sc_core::sc_stop();
+}
+
+bool Monitor::HasStopped() const
+{
+    return this->extrapolated or this->precisionreached or this->interrupted;
+}
+
+bool Monitor::IsInterrupted() const
+{
+    return this->interrupted;
+}
+
+
+
+void Monitor::EnablePeriodDetection(uint64_t totaliterations)
+{
+    this->perioddetection = true;
+    this->totaliterations = totaliterations;
+}
+
+
+
+void Monitor::DetectPeriod(sc_core::sc_time duration, sc_core::sc_time endtime)
+{
+    uint64_t         iteration = this->iterationended;
+    sc_core::sc_time gap       = endtime - this->lastendtime;
+    this->lastendtime = endtime;
+
+    // Count for each candidate period how many iterations in a row
+    // match the iteration one period earlier
+    for(unsigned int period = 1; period <= MAXPERIOD and period < iteration; period++)
+    {
+        uint64_t earlier = (iteration - period) & HISTORYMASK;
+        if(this->durationhistory[earlier] == duration and this->gaphistory[earlier] == gap)
+            this->periodmatches[period]++;
+        else
+            this->periodmatches[period] = 0;
+    }
+
+    this->durationhistory[iteration & HISTORYMASK] = duration;
+    this->gaphistory[iteration & HISTORYMASK]      = gap;
+
+    if(iteration >= this->totaliterations)
+        return;
+
+    for(unsigned int period = 1; period <= MAXPERIOD; period++)
+    {
+        if(this->periodmatches[period] >= CONFIRMATIONS)
+        {
+            this->Extrapolate(period);
+            return;
+        }
+    }
+}
+
+
+
+void Monitor::Extrapolate(unsigned int period)
+{
+    std::cerr << "\e[1;34mPeriodic behavior with a period of " << period << " iterations detected after "
+              << this->iterationended << " iterations. "
+              << "Extrapolating the remaining " << this->totaliterations - this->iterationended << " iterations.\e[0m\n";
+
+    for(uint64_t iteration = this->iterationended + 1; iteration <= this->totaliterations; iteration++)
+    {
+        sc_core::sc_time duration = this->durationhistory[(iteration - period) & HISTORYMASK];
+        this->durationhistory[iteration & HISTORYMASK] = duration;
+
+        if(this->enabledurationoutput == true and iteration > this->warmup)
+            this->AddSample(duration.value() / 1000);
+
+        this->iterationended = iteration;
+        if(this->precisionreached)     // AddSample stopped the simulation already
+            break;
+    }
+
+    this->extrapolated = true;
+    if(not this->precisionreached)
+        sc_core::sc_stop();
+}
+
+
+
+// The start times of the iterations in flight are stored in the order of the iterations,
+// so the capacity of the ring buffer may differ after loading.
+void Monitor::SaveState(std::ostream &state) const
+{
+    state::Write(state, this->iterationstarted);
+    state::Write(state, this->iterationended);
+    for(uint64_t iteration = this->iterationended + 1; iteration <= this->iterationstarted; iteration++)
+        state::Write<sc_dt::uint64>(state, this->iterationstarts[iteration & this->iterationmask].value());
+
+    this->statistics.SaveState(state);
+    state::Write<bool>(state, this->stoppingrule != nullptr);
+    if(this->stoppingrule != nullptr)
+        this->stoppingrule->SaveState(state);
+    state::Write(state, this->precisionreached);
+
+    state::Write(state, this->extrapolated);
+    state::Write<sc_dt::uint64>(state, this->lastendtime.value());
+    for(unsigned int i = 0; i <= HISTORYMASK; i++)
+    {
+        state::Write<sc_dt::uint64>(state, this->durationhistory[i].value());
+        state::Write<sc_dt::uint64>(state, this->gaphistory[i].value());
+    }
+    state::WriteVector(state, this->periodmatches);
+
+    this->samplesink->SaveState(state);
+}
+
+void Monitor::LoadState(std::istream &state)
+{
+    this->iterationstarted = state::Read<uint64_t>(state);
+    this->iterationended   = state::Read<uint64_t>(state);
+    if(this->iterationstarted < this->iterationended)
+        throw std::runtime_error("Checkpoint contains invalid iteration counters");
+    if(this->iterationstarted - this->iterationended > this->iterationstarts.size())
+        this->SetIterationCapacity(this->iterationstarted - this->iterationended);
+    for(uint64_t iteration = this->iterationended + 1; iteration <= this->iterationstarted; iteration++)
+        this->iterationstarts[iteration & this->iterationmask] = sc_core::sc_time::from_value(state::Read<sc_dt::uint64>(state));
+
+    this->statistics.LoadState(state);
+    if(state::Read<bool>(state) != (this->stoppingrule != nullptr))
+        throw std::runtime_error("Checkpoint does not match the stopping rule of the simulation");
+    if(this->stoppingrule != nullptr)
+        this->stoppingrule->LoadState(state);
+    this->precisionreached = state::Read<bool>(state);
+
+    this->extrapolated = state::Read<bool>(state);
+    this->lastendtime  = sc_core::sc_time::from_value(state::Read<sc_dt::uint64>(state));
+    for(unsigned int i = 0; i <= HISTORYMASK; i++)
+    {
+        this->durationhistory[i] = sc_core::sc_time::from_value(state::Read<sc_dt::uint64>(state));
+        this->gaphistory[i]      = sc_core::sc_time::from_value(state::Read<sc_dt::uint64>(state));
+    }
+    state::ReadVector(state, this->periodmatches);
+    if(this->periodmatches.size() != MAXPERIOD + 1)
+        throw std::runtime_error("Checkpoint does not match the period detection of the simulation");
+
+    this->samplesink->LoadState(state);
 }
 
 
@@ -1,13 +1,55 @@
 #ifndef MONITOR_HPP
 #define MONITOR_HPP
 
-#include <map>
+#include <cstdint>
+#include <istream>
+#include <ostream>
 #include <string>
+#include <vector>
 #include <systemc>
+#include <samplesink.hpp>
+#include <statistics.hpp>
+#include <stoppingrule.hpp>
 #ifdef ENABLE_EVD
 #include <evdgen.hpp>
 #endif
 
+// Signals get registered once by name.
+// Afterwards they are referenced by the returned ID.
+typedef unsigned int TraceSignal;
+
+// The values a signal can take in the trace.
+// Their names are defined in monitor.cpp (TracePhaseNames).
+enum TRACEPHASE
+{
+    // Memory
+    MEMORY_IDLE,
+    MEMORY_READ,
+    MEMORY_WRITE,
+    MEMORY_ERROR,
+    // Tile
+    TILE_ACTIVE,
+    // Actor
+    ACTOR_READ,
+    ACTOR_COMPUTE,
+    ACTOR_WRITE,
+    ACTOR_IDLE,
+    // Channel
+    CHANNEL_IDLE,
+    CHANNEL_READINIT,
+    CHANNEL_READPOLLING,
+    CHANNEL_READPREPARE,
+    CHANNEL_READCOPYING,
+    CHANNEL_READMANAGE,
+    CHANNEL_READIDLE,
+    CHANNEL_WRITEINIT,
+    CHANNEL_WRITEPOLLING,
+    CHANNEL_WRITEPREPARE,
+    CHANNEL_WRITECOPYING,
+    CHANNEL_WRITEMANAGE,
+    CHANNEL_WRITEIDLE
+};
+
 class Monitor
 {
     public:
@@ -17,21 +59,94 @@ class Monitor
         void IterationBegin();
         void IterationEnd();
 
+        // The start times of all iterations that are in flight get buffered.
+        // The capacity gets rounded up to a power of two.
+        void SetIterationCapacity(size_t inflight);
+
+        // With constant actor delays, the self-timed execution becomes periodic.
+        // When the iteration durations and the time between the end of two iterations
+        // repeat with a period of up to MAXPERIOD iterations, the remaining durations
+        // up to totaliterations get extrapolated and the simulation stops.
+        void EnablePeriodDetection(uint64_t totaliterations);
+
+        // The simulation stops as soon as the stopping rule is satisfied by the recorded durations
+        void SetStoppingRule(StoppingRule *rule);
+
+        // Stops the simulation after an interrupt signal (see interruption.hpp).
+        // The iterations that end in the same delta cycle still get recorded.
+        void Interrupt();
+
+        // true after the monitor stopped the simulation (extrapolation, precision reached or interrupted)
+        bool HasStopped() const;
+        bool IsInterrupted() const;
+
+        // The durations of the first iterations only bring the pipeline into a realistic state.
+        // They do not get written to the sink or into the statistics.
+        void SetWarmup(uint64_t iterations);
+
         void EnableDurationOutput(bool enable=true);
+        void SetSampleSink(SampleSink *sink);  // Default: Text to stdout
+        OnlineStatistics& GetStatistics();     // of all iteration durations written to the sink
         void EnableAppOutput(bool enable=true);
         
         void EnableTraceOutput(const char* tracepath=nullptr);
-        void ExpandTrace(std::string signalname, std::string value);
+        bool IsTraceEnabled() const;
+
+        TraceSignal RegisterSignal(const std::string &signalname);
+
+        // Without libevd this compiles to nothing.
+        // Otherwise, disabled tracing costs one branch.
+        inline void ExpandTrace(TraceSignal signal, TRACEPHASE phase)
+        {
+#ifdef ENABLE_EVD
+            if(this->enabletraceoutput)
+                this->AddTraceEvent(signal, phase);
+#else
+            (void)signal;
+            (void)phase;
+#endif
+        }
 
         void PrintAppOutput(std::string output);
 
+        // Iteration counters, statistics, stopping rule, period detection and the position of the sample sink,
+        // for checkpoints. The signals and the trace are not part of the state.
+        void SaveState(std::ostream &state) const;
+        void LoadState(std::istream &state);
+
     private:
+        void AddTraceEvent(TraceSignal signal, TRACEPHASE phase);
+        void AddSample(uint64_t duration);
+        void DetectPeriod(sc_core::sc_time duration, sc_core::sc_time endtime);
+        void Extrapolate(unsigned int period);
+
         bool enableappoutput;
         bool enabledurationoutput;
         bool enabletraceoutput;
-        unsigned int iterationstarted;
-        unsigned int iterationended;
-        std::map<unsigned int, sc_core::sc_time> iterationstarts;
+        uint64_t iterationstarted;
+        uint64_t iterationended;
+        uint64_t warmup;                               // Number of discarded iterations
+        std::vector<sc_core::sc_time> iterationstarts; // Ring buffer indexed by iteration number
+        uint64_t iterationmask;                        // iterationstarts.size() - 1
+        std::vector<std::string> signalnames; // Indexed by TraceSignal
+
+        TextSampleSink defaultsink;
+        SampleSink     *samplesink;
+        OnlineStatistics statistics;
+        StoppingRule     *stoppingrule;    // Can be NULL!
+        bool             precisionreached;
+        bool             interrupted;
+
+        static const unsigned int MAXPERIOD     = 64;   // in iterations
+        static const unsigned int HISTORYMASK   = 127;  // History size must be > MAXPERIOD
+        static const unsigned int CONFIRMATIONS = 1000; // matching iterations needed to accept a period
+        bool     perioddetection;
+        bool     extrapolated;
+        uint64_t totaliterations;
+        sc_core::sc_time lastendtime;
+        std::vector<sc_core::sc_time> durationhistory; // Indexed by iteration number & HISTORYMASK
+        std::vector<sc_core::sc_time> gaphistory;
+        std::vector<unsigned int>     periodmatches;   // Indexed by period
 
 #ifdef ENABLE_EVD
         EventDumpGenerator evd;
@@ -0,0 +1,203 @@
+#include <parallelrun.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <interruption.hpp>
+
+ParallelRun::ParallelRun(unsigned int jobs, uint64_t skip, uint64_t iterations, uint64_t warmup)
+    : iterations(iterations)
+{
+    jobs = std::max<uint64_t>(std::min<uint64_t>(jobs, iterations), 1);
+
+    const char *tmpdir = getenv("TMPDIR");
+    std::string pattern = std::string(tmpdir != nullptr ? tmpdir : "/tmp") + "/smc-shard-XXXXXX";
+
+    // The remaining iterations get distributed over the first shards
+    uint64_t first = skip;
+    for(unsigned int job = 0; job < jobs; job++)
+    {
+        Shard shard;
+        shard.first  = first;
+        shard.count  = iterations / jobs + (job < iterations % jobs ? 1 : 0);
+        shard.warmup = job == 0 ? 0 : std::min(warmup, first);
+        shard.pid    = 0;
+
+        std::vector<char> path(pattern.begin(), pattern.end());
+        path.push_back('\0');
+        int fd = mkstemp(path.data());
+        if(fd < 0)
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m Creating a temporary sample file in " << pattern
+                      << " failed - " << strerror(errno) << "\n";
+            throw std::runtime_error("Creating sample file failed!");
+        }
+        close(fd);
+        shard.path = path.data();
+
+        this->shards.push_back(shard);
+        first += shard.count;
+    }
+}
+
+
+
+ParallelRun::~ParallelRun()
+{
+    for(const Shard &shard : this->shards)
+        unlink(shard.path.c_str());
+}
+
+
+
+size_t ParallelRun::GetJobs() const
+{
+    return this->shards.size();
+}
+
+
+
+const Shard* ParallelRun::Fork()
+{
+    // Buffered output would be written by the parent and by each worker
+    std::cout.flush();
+    std::cerr.flush();
+
+    pid_t parent = getpid();
+    for(Shard &shard : this->shards)
+    {
+        shard.pid = fork();
+        if(shard.pid == 0)
+        {
+            // Workers must not outlive an aborted parent.
+            // Signals from the terminal only reach the parent, which forwards them once (see Wait).
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+            if(getppid() != parent)
+                _exit(EXIT_FAILURE);
+            setpgid(0, 0);
+            return &shard;
+        }
+
+        if(shard.pid < 0)
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m Starting worker process failed - " << strerror(errno) << "\n";
+            for(const Shard &started : this->shards)
+            {
+                if(started.pid > 0)
+                {
+                    kill(started.pid, SIGTERM);
+                    waitpid(started.pid, nullptr, 0);
+                }
+            }
+            throw std::runtime_error("Forking worker failed!");
+        }
+        setpgid(shard.pid, shard.pid);  // Like in the worker, whichever comes first
+    }
+
+    std::cerr << "\e[1;34mSimulating " << this->iterations << " iterations with " << this->shards.size() << " workers\e[0m\n";
+    for(const Shard &shard : this->shards)
+        std::cerr << "\e[1;30m    Worker " << shard.pid << ": iterations " << shard.first << " - " << shard.first + shard.count - 1
+                  << " (" << shard.warmup << " warm-up iterations)\e[0m\n";
+    return nullptr;
+}
+
+
+
+// An interrupt signal gets forwarded to the workers that are still running.
+// They were not reaped yet, so their process IDs are still valid.
+bool ParallelRun::Wait()
+{
+    bool success   = true;
+    bool forwarded = false;
+    for(size_t index = 0; index < this->shards.size(); index++)
+    {
+        Shard &shard = this->shards[index];
+        int status;
+        while(true)
+        {
+            if(Interruption::IsRequested() and not forwarded)
+            {
+                for(size_t running = index; running < this->shards.size(); running++)
+                    kill(this->shards[running].pid, Interruption::GetSignal());
+                forwarded = true;
+            }
+
+            if(waitpid(shard.pid, &status, 0) >= 0)
+                break;
+            if(errno != EINTR)
+            {
+                status = -1;
+                break;
+            }
+        }
+
+        if(status >= 0 and WIFEXITED(status) and WEXITSTATUS(status) == EXIT_SUCCESS)
+            continue;
+
+        std::cerr << "\e[1;31mERROR:\e[0m Worker " << shard.pid << " for iterations starting at " << shard.first << " failed";
+        if(status >= 0 and WIFSIGNALED(status))
+            std::cerr << " \e[1;30m(" << strsignal(WTERMSIG(status)) << ")\e[0m";
+        else if(status >= 0 and WIFEXITED(status))
+            std::cerr << " \e[1;30m(exit code " << WEXITSTATUS(status) << ")\e[0m";
+        std::cerr << "\n";
+        success = false;
+    }
+    return success;
+}
+
+
+
+bool ParallelRun::Merge(SampleSink &sink, OnlineStatistics &statistics, bool partial) const
+{
+    bool     consistent = true;
+    uint64_t merged     = 0;
+    for(const Shard &shard : this->shards)
+    {
+        uint64_t count = 0;
+        try
+        {
+            BinarySampleSource source(shard.path.c_str());
+            uint64_t sample;
+            while(source.Read(sample))
+            {
+                sink.Write(sample);
+                statistics.Add(sample);
+                count++;
+            }
+        }
+        catch(const std::runtime_error &e)
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m Reading samples of worker " << shard.pid << " failed - " << e.what() << "\n";
+            consistent = false;
+        }
+
+        merged += count;
+        if(partial and count < shard.count)
+        {
+            std::cerr << "\e[1;33mWARNING:\e[0m Worker " << shard.pid << " got interrupted after " << count << " of "
+                      << shard.count << " samples \e[1;30m(Dropping the following shards)\e[0m\n";
+            return consistent;
+        }
+        if(count != shard.count)
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m Worker " << shard.pid << " delivered " << count << " samples instead of "
+                      << shard.count << "\n";
+            consistent = false;
+        }
+    }
+
+    if(merged != this->iterations)
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Merged " << merged << " samples, but " << this->iterations << " iterations were simulated\n";
+        consistent = false;
+    }
+    return consistent;
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,57 @@
+#ifndef PARALLELRUN_HPP
+#define PARALLELRUN_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <samplesink.hpp>
+#include <statistics.hpp>
+
+// Splits the iterations of a simulation into consecutive shards that get simulated by forked worker processes.
+//
+// The workers get forked after the experiment is completely set up, so they share the loaded
+// delay vectors and applications copy-on-write with the parent.
+// Each worker continues at the delay vector position of its shard.
+// Because a worker starts with empty channels, it simulates some warm-up iterations before its shard
+// and discards their durations. The first shard starts where a single simulation would start and needs no warm-up.
+//
+// Each worker writes the durations of its shard into a temporary binary sample file.
+// The parent merges these files in shard order.
+
+struct Shard
+{
+    uint64_t    first;      // Position of the first iteration in the delay vectors (including --skip)
+    uint64_t    count;      // Number of iterations of the shard
+    uint64_t    warmup;     // Number of discarded iterations simulated before first
+    std::string path;       // Sample file written by the worker
+    pid_t       pid;
+};
+
+class ParallelRun
+{
+    public:
+        ParallelRun(unsigned int jobs, uint64_t skip, uint64_t iterations, uint64_t warmup);
+        ~ParallelRun();     // Removes the sample files
+
+        // Returns the shard of the worker in the worker process, nullptr in the parent process.
+        const Shard* Fork();
+
+        // Waits for all workers. Returns false if at least one of them failed.
+        bool Wait();
+
+        // Writes the samples of all shards in order into the sink and the statistics.
+        // Returns false if the number of samples of a shard does not match its number of iterations.
+        // After an interruption (partial), the merge stops after the first incomplete shard,
+        // so the written samples are the consecutive iterations from the beginning.
+        bool Merge(SampleSink &sink, OnlineStatistics &statistics, bool partial = false) const;
+
+        size_t GetJobs() const;
+
+    private:
+        std::vector<Shard> shards;
+        uint64_t           iterations;
+};
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
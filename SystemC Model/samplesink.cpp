@@ -0,0 +1,347 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <samplesink.hpp>
+#include <statestream.hpp>
+
+// Text Sink ///////////////
+
+
+TextSampleSink::TextSampleSink(const char *path, bool resume)
+    : path(path != nullptr ? path : "")
+    , stream(&std::cout)
+{
+    if(path != nullptr)
+    {
+        if(resume)
+            this->file.open(path, std::ios::in | std::ios::out);
+        else
+            this->file.open(path);
+        if(not this->file.is_open())
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m Opening " << path << " failed! \e[1;30m(Writing samples to stdout instead)\n";
+            return;
+        }
+        this->stream = &this->file;
+    }
+}
+
+
+
+void TextSampleSink::Write(uint64_t sample)
+{
+    *this->stream << std::dec << sample << "\n";
+}
+
+
+
+void TextSampleSink::Close()
+{
+    this->stream->flush();
+    if(this->file.is_open())
+        this->file.close();
+}
+
+
+
+// Cuts the file at the given length and continues writing there
+static void TruncateSampleFile(std::ofstream &file, const std::string &path, std::streamoff length)
+{
+    file.flush();
+    if(truncate(path.c_str(), length) != 0)
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Truncating " << path << " to the checkpoint failed - " << strerror(errno) << "\n";
+        throw std::runtime_error("Restoring sample sink failed!");
+    }
+    file.seekp(length);
+    if(file.fail())
+        throw std::runtime_error("Restoring sample sink failed!");
+}
+
+// Makes sure the flushed samples are on the disk.
+// The file streams do not expose their descriptor, but fsync covers all data of the file.
+static void SyncSampleFile(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0 or fsync(fd) != 0)
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Syncing " << path << " failed - " << strerror(errno) << "\n";
+        if(fd >= 0)
+            close(fd);
+        throw std::runtime_error("Saving sample sink failed!");
+    }
+    close(fd);
+}
+
+// The length is -1 if the samples go to stdout
+void TextSampleSink::SaveState(std::ostream &state)
+{
+    this->stream->flush();
+    std::streamoff length = -1;
+    if(this->file.is_open())
+    {
+        length = static_cast<std::streamoff>(this->file.tellp());
+        SyncSampleFile(this->path);
+    }
+    state::Write<int64_t>(state, length);
+}
+
+void TextSampleSink::LoadState(std::istream &state)
+{
+    std::streamoff length = state::Read<int64_t>(state);
+    if(not this->file.is_open())
+        return;
+
+    if(length < 0)
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m The samples before the checkpoint were written to stdout. "
+                  << "\e[1;30m(" << this->path << " only contains the samples after the checkpoint)\e[0m\n";
+        length = 0;
+    }
+    TruncateSampleFile(this->file, this->path, length);
+}
+
+
+
+// Binary Sink ///////////////
+
+
+const char BinarySampleSink::MAGIC[4] = {'S', 'M', 'C', 'D'};
+const size_t BUFFERSIZE = 4 * 1024 * 1024;
+const size_t MAXVARINTSIZE = 10;    // 64 bit / 7 bit per byte
+
+// The header gets prepared in any case. When resuming, LoadState drops it before it gets written.
+BinarySampleSink::BinarySampleSink(const char *path, const std::string &experimentname, uint64_t seed, uint64_t skip, bool resume)
+    : path(path)
+    , file(path, resume ? std::ios::binary | std::ios::in | std::ios::out : std::ios::binary | std::ios::trunc)
+    , buffer(BUFFERSIZE)
+    , fill(0)
+    , count(0)
+    , previous(0)
+    , closed(false)
+{
+    if(not this->file.is_open())
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Opening " << path << " for writing samples failed!\n";
+        throw std::runtime_error("Opening sample sink failed!");
+    }
+
+    for(char c : MAGIC)
+        this->buffer[this->fill++] = c;
+    this->PutInteger(VERSION,  2);
+    this->PutInteger(ENCODING, 2);
+    this->PutInteger(seed,     8);
+    this->PutInteger(skip,     8);
+    this->countposition = this->fill;
+    this->PutInteger(UINT64_MAX, 8);
+    this->PutInteger(experimentname.size(), 4);
+    for(char c : experimentname)
+        this->buffer[this->fill++] = c;
+}
+
+BinarySampleSink::~BinarySampleSink()
+{
+    this->Close();
+}
+
+
+
+void BinarySampleSink::PutInteger(uint64_t value, unsigned int bytes)
+{
+    for(unsigned int i = 0; i < bytes; i++)
+    {
+        this->buffer[this->fill++] = value & 0xFF;
+        value >>= 8;
+    }
+}
+
+
+
+void BinarySampleSink::Write(uint64_t sample)
+{
+    if(this->fill + MAXVARINTSIZE > this->buffer.size())
+        this->Flush();
+
+    // Consecutive durations are similar, so their differences need only few bytes.
+    // Zigzag encoding maps small negative differences to small positive numbers.
+    int64_t  delta   = static_cast<int64_t>(sample - this->previous);
+    uint64_t zigzag  = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+    this->previous   = sample;
+
+    while(zigzag >= 0x80)
+    {
+        this->buffer[this->fill++] = (zigzag & 0x7F) | 0x80;
+        zigzag >>= 7;
+    }
+    this->buffer[this->fill++] = zigzag;
+
+    this->count++;
+}
+
+
+
+void BinarySampleSink::Flush()
+{
+    this->file.write(reinterpret_cast<const char*>(this->buffer.data()), this->fill);
+    this->fill = 0;
+}
+
+
+
+void BinarySampleSink::SaveState(std::ostream &state)
+{
+    this->Flush();
+    this->file.flush();
+    SyncSampleFile(this->path);
+    state::Write<int64_t>(state, static_cast<std::streamoff>(this->file.tellp()));
+    state::Write<int64_t>(state, static_cast<std::streamoff>(this->countposition));
+    state::Write(state, this->count);
+    state::Write(state, this->previous);
+}
+
+void BinarySampleSink::LoadState(std::istream &state)
+{
+    std::streamoff length = state::Read<int64_t>(state);
+    this->countposition   = static_cast<std::streamoff>(state::Read<int64_t>(state));
+    this->count           = state::Read<uint64_t>(state);
+    this->previous        = state::Read<uint64_t>(state);
+
+    this->fill = 0;
+    TruncateSampleFile(this->file, this->path, length);
+}
+
+
+
+void BinarySampleSink::Close()
+{
+    if(this->closed)
+        return;
+    this->closed = true;
+
+    this->Flush();
+
+    // Patch the number of samples into the header.
+    // This is not possible for pipes, there the number of samples stays unknown.
+    this->file.seekp(this->countposition);
+    if(this->file.fail())
+        this->file.clear();
+    else
+    {
+        this->PutInteger(this->count, 8);
+        this->Flush();
+    }
+
+    this->file.close();
+    if(this->file.fail())
+        std::cerr << "\e[1;31mERROR:\e[0m Writing samples failed!\n";
+}
+
+// Binary Source ///////////////
+
+
+BinarySampleSource::BinarySampleSource(const char *path)
+    : file(path, std::ios::binary)
+    , buffer(BUFFERSIZE)
+    , fill(0)
+    , position(0)
+    , count(0)
+    , skip(0)
+    , previous(0)
+{
+    if(not this->file.is_open())
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Opening " << path << " for reading samples failed!\n";
+        throw std::runtime_error("Opening sample source failed!");
+    }
+
+    // Fixed part of the header, see BinarySampleSink
+    uint8_t header[36];
+    for(uint8_t &byte : header)
+    {
+        if(not this->GetByte(byte))
+            throw std::runtime_error("Reading sample file header failed!");
+    }
+    auto integer = [&header](unsigned int offset, unsigned int bytes)
+    {
+        uint64_t value = 0;
+        for(unsigned int i = 0; i < bytes; i++)
+            value |= static_cast<uint64_t>(header[offset + i]) << (8 * i);
+        return value;
+    };
+
+    for(unsigned int i = 0; i < sizeof(BinarySampleSink::MAGIC); i++)
+    {
+        if(header[i] != static_cast<uint8_t>(BinarySampleSink::MAGIC[i]))
+            throw std::runtime_error("Invalid sample file!");
+    }
+    if(integer(4, 2) != BinarySampleSink::VERSION or integer(6, 2) != BinarySampleSink::ENCODING)
+        throw std::runtime_error("Unsupported sample file version!");
+
+    this->skip  = integer(16, 8);
+    this->count = integer(24, 8);
+
+    uint8_t byte;
+    for(uint64_t namelength = integer(32, 4); namelength > 0; namelength--)
+    {
+        if(not this->GetByte(byte))
+            throw std::runtime_error("Reading sample file header failed!");
+    }
+}
+
+
+
+bool BinarySampleSource::GetByte(uint8_t &byte)
+{
+    if(this->position == this->fill)
+    {
+        this->file.read(this->buffer.data(), this->buffer.size());
+        this->fill     = this->file.gcount();
+        this->position = 0;
+        if(this->fill == 0)
+            return false;
+    }
+    byte = static_cast<uint8_t>(this->buffer[this->position++]);
+    return true;
+}
+
+
+
+bool BinarySampleSource::Read(uint64_t &sample)
+{
+    uint64_t     zigzag = 0;
+    unsigned int shift  = 0;
+    uint8_t      byte;
+    do
+    {
+        if(not this->GetByte(byte))
+        {
+            if(shift > 0)
+                throw std::runtime_error("Sample file ends in the middle of a sample!");
+            return false;
+        }
+        zigzag |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        shift  += 7;
+    }
+    while((byte & 0x80) and shift < 64);
+
+    int64_t delta  = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    this->previous = this->previous + static_cast<uint64_t>(delta);
+    sample         = this->previous;
+    return true;
+}
+
+
+
+uint64_t BinarySampleSource::GetCount() const
+{
+    return this->count;
+}
+
+uint64_t BinarySampleSource::GetSkip() const
+{
+    return this->skip;
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
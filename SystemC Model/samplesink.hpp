@@ -0,0 +1,128 @@
+#ifndef SAMPLESINK_HPP
+#define SAMPLESINK_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// A sample sink receives the iteration durations (in ns) collected by the Monitor.
+
+class SampleSink
+{
+    public:
+        virtual ~SampleSink(){};
+
+        virtual void Write(uint64_t sample) = 0;
+        virtual void Close() {};    // Flushes all buffered samples
+
+        // Checkpoints: Saving writes all buffered samples to the disk and stores how much output belongs to the checkpoint.
+        // Loading drops the output written after the checkpoint and continues from there.
+        virtual void SaveState(std::ostream &) {};
+        virtual void LoadState(std::istream &) {};
+};
+
+
+
+// One decimal number per line.
+// Without a path, the samples get written to stdout.
+// When resuming a checkpoint, the existing file gets kept until LoadState cuts it at the checkpoint.
+// Samples written to stdout before the checkpoint do not get repeated.
+
+class TextSampleSink : public SampleSink
+{
+    public:
+        TextSampleSink(const char *path = nullptr, bool resume = false);
+
+        virtual void Write(uint64_t sample);
+        virtual void Close();
+
+        virtual void SaveState(std::ostream &state);
+        virtual void LoadState(std::istream &state);
+
+    private:
+        std::string   path;
+        std::ofstream file;
+        std::ostream *stream;
+};
+
+
+
+// Binary format (all integers little endian):
+//
+//   offset  size  content
+//    0      4     magic "SMCD"
+//    4      2     version (1)
+//    6      2     encoding (1: zigzag encoded difference to the previous sample as LEB128 varint)
+//    8      8     seed of the random number generators
+//   16      8     number of skipped samples
+//   24      8     number of samples, UINT64_MAX if the file was not closed properly
+//   32      4     length n of the experiment name
+//   36      n     experiment name (not null terminated)
+//   36+n          samples
+//
+// The first sample is encoded as difference to 0.
+// Results/smcd.py reads this format outside of the model.
+
+class BinarySampleSink : public SampleSink
+{
+    public:
+        // When resuming a checkpoint, the existing file gets kept until LoadState cuts it at the checkpoint
+        BinarySampleSink(const char *path, const std::string &experimentname, uint64_t seed, uint64_t skip, bool resume = false);
+        virtual ~BinarySampleSink();
+
+        virtual void Write(uint64_t sample);
+        virtual void Close();
+
+        virtual void SaveState(std::ostream &state);
+        virtual void LoadState(std::istream &state);
+
+        static const char     MAGIC[4];
+        static const uint16_t VERSION  = 1;
+        static const uint16_t ENCODING = 1;
+
+    private:
+        void Flush();
+        void PutInteger(uint64_t value, unsigned int bytes);
+
+        std::string          path;
+        std::ofstream        file;
+        std::vector<uint8_t> buffer;
+        size_t               fill;          // used bytes of the buffer
+        std::streampos       countposition; // where the number of samples gets patched in
+        uint64_t             count;
+        uint64_t             previous;
+        bool                 closed;
+};
+
+
+
+// Reads the samples of a file written by the BinarySampleSink.
+
+class BinarySampleSource
+{
+    public:
+        BinarySampleSource(const char *path);  // Throws std::runtime_error for invalid files
+
+        bool Read(uint64_t &sample);    // false at the end of the file
+
+        uint64_t GetCount() const;      // from the header, UINT64_MAX if unknown
+        uint64_t GetSkip()  const;
+
+    private:
+        bool GetByte(uint8_t &byte);
+
+        std::ifstream        file;
+        std::vector<char>    buffer;
+        size_t               fill;
+        size_t               position;  // in buffer
+        uint64_t             count;
+        uint64_t             skip;
+        uint64_t             previous;
+};
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
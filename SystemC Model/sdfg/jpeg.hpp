@@ -4,6 +4,7 @@
 #include <software/sdf.h>
 #include <software/actor.hpp>
 #include <monitor.hpp>
+#include <statestream.hpp>
 
 namespace JPEG
 {
@@ -327,9 +328,11 @@ class CreateRGBPixels: public Actor
 {
     public:
         CreateRGBPixels(std::string name, DelayVectorMap &delaymap, Monitor &monitor, SDFApplication &application)
-            : Actor(name, delaymap, monitor, application) {};
+            : Actor(name, delaymap, monitor, application), block_x(0), block_y(0) {};
 
         void Initialize() override;
+        void SaveState(std::ostream &state) const override;
+        void LoadState(std::istream &state) override;
 
     protected:
         void ReadPhase() override;
@@ -341,6 +344,8 @@ class CreateRGBPixels: public Actor
         CreateRGBPixels_t Function;
         uint16_t Image_xdimension;
         uint16_t Image_ydimension;
+        int      block_x;   // Position of the next printed block
+        int      block_y;
 
         token_t y[64];
         token_t cr[64];
@@ -363,6 +368,18 @@ void CreateRGBPixels::Initialize()
         throw std::runtime_error("Cannot load Image_ydimension");
     this->Image_ydimension = *wordptr;
 }
+void CreateRGBPixels::SaveState(std::ostream &state) const
+{
+    this->Actor::SaveState(state);
+    state::Write<int32_t>(state, this->block_x);
+    state::Write<int32_t>(state, this->block_y);
+}
+void CreateRGBPixels::LoadState(std::istream &state)
+{
+    this->Actor::LoadState(state);
+    this->block_x = state::Read<int32_t>(state);
+    this->block_y = state::Read<int32_t>(state);
+}
 void CreateRGBPixels::ReadPhase()
 {
     this->channels_in[0]->ReadTokens(this->y);
@@ -380,8 +397,7 @@ void CreateRGBPixels::PrintImageChunk(token_t pixels[64])
 {
     std::string output = "";
 
-    static int block_x, block_y;
-    if(block_x == 0 && block_y == 0)
+    if(this->block_x == 0 && this->block_y == 0)
         output += "\e[1;1H\e[0m\e[2J";   // Begin of screen and clear
 
     for(int y=0; y<8; y++)
@@ -405,14 +421,14 @@ void CreateRGBPixels::PrintImageChunk(token_t pixels[64])
         output += "\e[16D\e[1B"; // 8 left, 1 down
     }
 
-    block_x++;
-    if(block_x >= this->Image_xdimension/8)
+    this->block_x++;
+    if(this->block_x >= this->Image_xdimension/8)
     {
-        block_x = 0;
-        block_y++;
+        this->block_x = 0;
+        this->block_y++;
         output += "\e[1G"; // Begin of line
-        if(block_y >= this->Image_ydimension/8)
-            block_y = 0;
+        if(this->block_y >= this->Image_ydimension/8)
+            this->block_y = 0;
     }
     else
     {
@@ -4,6 +4,7 @@
 #include <software/sdf.h>
 #include <software/actor.hpp>
 #include <monitor.hpp>
+#include <statestream.hpp>
 
 
 namespace Sobel2
@@ -19,8 +20,8 @@ typedef token_t (*ABS_t)      (token_t tokensIn1[1], token_t tokensIn2[1]);
 class GetPixel: public Actor
 {
     public:
-        GetPixel(std::string name, DelayVectorMap &delaymap, Monitor &monitor, SDFApplication &application, bool enabledd=false)
-            : Actor(name, delaymap, monitor, application) {this->datadependentdelay=enabledd;};
+        GetPixel(std::string name, DelayVectorMap &delaymap, Monitor &monitor, SDFApplication &application)
+            : Actor(name, delaymap, monitor, application) {};
 
         void Initialize() override;
 
@@ -28,6 +29,8 @@ class GetPixel: public Actor
         void ReadPhase() override;
         void ComputePhase() override;
         void WritePhase() override;
+        size_t DelayKey() override;
+        size_t DelayKeyCount() const override;
 
     private:
         GetPixel_t GetPixelFunction;
@@ -36,8 +39,6 @@ class GetPixel: public Actor
 
         token_t position[2];
         token_t tokens[9];
-
-        bool datadependentdelay;
 };
 
 void GetPixel::Initialize()
@@ -58,53 +59,30 @@ void GetPixel::Initialize()
     if(byteptr == nullptr)
         throw std::runtime_error("Cannot load ImageWidth");
     this->ImageWidth = *byteptr;
-
-    if(this->datadependentdelay)
-        std::cerr << "\e[1;33mWARNING:\e[0m Data Dependent Delays only represent MicroBlazes with Extended ALU.\e[0m\n";
 }
 void GetPixel::ReadPhase()
 {
     this->channels_in[0]->ReadTokens(this->position);
 }
+// The delay depends on the position of the pixel:
+// key = 3*row + column, with row and column 0 at the top/left border,
+// 1 inside the image, and 2 at the bottom/right border.
+size_t GetPixel::DelayKey()
+{
+    auto x = this->position[0];
+    auto y = this->position[1];
+
+    size_t column = (x == 0) ? 0 : (x == this->ImageWidth -1) ? 2 : 1;
+    size_t row    = (y == 0) ? 0 : (y == this->ImageHeight-1) ? 2 : 1;
+    return 3*row + column;
+}
+size_t GetPixel::DelayKeyCount() const
+{
+    return 9;
+}
 void GetPixel::ComputePhase()
 {
-    if(this->datadependentdelay)
-    {
-        auto x = this->position[0];
-        auto y = this->position[1];
-
-        if(x == 0)
-        {
-            if(y == 0)
-                sc_core::wait(sc_core::sc_time(1401, sc_core::SC_NS));  // top left
-            else if(y == this->ImageHeight-1)
-                sc_core::wait(sc_core::sc_time(1452, sc_core::SC_NS));  // bottom left
-            else
-                sc_core::wait(sc_core::sc_time(1431, sc_core::SC_NS));  // left edge
-        }
-        else if(x == this->ImageWidth-1)
-        {
-            if(y == 0)
-                sc_core::wait(sc_core::sc_time(1500, sc_core::SC_NS));  // top right
-            else if(y == this->ImageHeight-1)
-                sc_core::wait(sc_core::sc_time(1551, sc_core::SC_NS));  // bottom right
-            else
-                sc_core::wait(sc_core::sc_time(1530, sc_core::SC_NS));  // right edge
-        }
-        else
-        {
-            if(y == 0)
-                sc_core::wait(sc_core::sc_time(1431, sc_core::SC_NS));  // top edge
-            else if(y == this->ImageHeight-1)
-                sc_core::wait(sc_core::sc_time(1482, sc_core::SC_NS));  // bottom edge
-            else
-                sc_core::wait(sc_core::sc_time(1461, sc_core::SC_NS));  // normal case
-        }
-    }
-    else
-    {
-        sc_core::wait(this->delayvector->GetDelay());
-    }
+    sc_core::wait(this->GetComputeDelay());
     this->GetPixelFunction(this->position, this->tokens);
 }
 void GetPixel::WritePhase()
@@ -121,8 +99,8 @@ void GetPixel::WritePhase()
 class GX: public Actor
 {
     public:
-        GX(std::string name, DelayVectorMap &delaymap, Monitor &monitor, SDFApplication &application, bool enabledd=false)
-            : Actor(name, delaymap, monitor, application) {this->datadependentdelay=enabledd;};
+        GX(std::string name, DelayVectorMap &delaymap, Monitor &monitor, SDFApplication &application)
+            : Actor(name, delaymap, monitor, application) {};
 
         void Initialize() override;
 
@@ -135,8 +113,6 @@ class GX: public Actor
         GX_t GXFunction;
         token_t tokens_in[9];
         token_t tokens_out[1];
-
-        bool datadependentdelay;
 };
 
 void GX::Initialize()
@@ -144,9 +120,6 @@ void GX::Initialize()
     this->GXFunction = (GX_t) this->Actor::application->LoadActor("GX");
     if(this->GXFunction == nullptr)
         throw std::runtime_error("Cannot load GX function");
-
-    if(this->datadependentdelay)
-        std::cerr << "\e[1;33mWARNING:\e[0m Data Dependent Delays only represent MicroBlazes with Extended ALU.\e[0m\n";
 }
 void GX::ReadPhase()
 {
@@ -154,15 +127,7 @@ void GX::ReadPhase()
 }
 void GX::ComputePhase()
 {
-    if(this->datadependentdelay)
-    {
-        sc_core::wait(sc_core::sc_time(478, sc_core::SC_NS));
-    }
-    else
-    {
-        sc_core::wait(this->delayvector->GetDelay());
-    }
-
+    sc_core::wait(this->GetComputeDelay());
     this->GXFunction(this->tokens_in, this->tokens_out);
 }
 void GX::WritePhase()
@@ -177,8 +142,8 @@ void GX::WritePhase()
 class GY: public Actor
 {
     public:
-        GY(std::string name, DelayVectorMap &delaymap, Monitor &monitor, SDFApplication &application, bool enabledd=false)
-            : Actor(name, delaymap, monitor, application) {this->datadependentdelay=enabledd;};
+        GY(std::string name, DelayVectorMap &delaymap, Monitor &monitor, SDFApplication &application)
+            : Actor(name, delaymap, monitor, application) {};
 
         void Initialize() override;
 
@@ -191,8 +156,6 @@ class GY: public Actor
         GY_t GYFunction;
         token_t tokens_in[9];
         token_t tokens_out[1];
-
-        bool datadependentdelay;
 };
 
 void GY::Initialize()
@@ -200,9 +163,6 @@ void GY::Initialize()
     this->GYFunction = (GY_t) this->Actor::application->LoadActor("GY");
     if(this->GYFunction == nullptr)
         throw std::runtime_error("Cannot load GY function");
-
-    if(this->datadependentdelay)
-        std::cerr << "\e[1;33mWARNING:\e[0m Data Dependent Delays only represent MicroBlazes with Extended ALU.\e[0m\n";
 }
 void GY::ReadPhase()
 {
@@ -210,15 +170,7 @@ void GY::ReadPhase()
 }
 void GY::ComputePhase()
 {
-    if(this->datadependentdelay)
-    {
-        sc_core::wait(sc_core::sc_time(478, sc_core::SC_NS));
-    }
-    else
-    {
-        sc_core::wait(this->delayvector->GetDelay());
-    }
-
+    sc_core::wait(this->GetComputeDelay());
     this->GYFunction(this->tokens_in, this->tokens_out);
 }
 void GY::WritePhase()
@@ -233,21 +185,24 @@ void GY::WritePhase()
 class ABS: public Actor
 {
     public:
-        ABS(std::string name, DelayVectorMap &delaymap, Monitor &monitor, SDFApplication &application, bool enabledd=false)
-            : Actor(name, delaymap, monitor, application) {this->datadependentdelay=enabledd;};
+        ABS(std::string name, DelayVectorMap &delaymap, Monitor &monitor, SDFApplication &application)
+            : Actor(name, delaymap, monitor, application), iteration(0) {};
 
         void Initialize() override;
+        void SaveState(std::ostream &state) const override;
+        void LoadState(std::istream &state) override;
 
     protected:
         void ReadPhase() override;
         void ComputePhase() override;
+        size_t DelayKey() override;
+        size_t DelayKeyCount() const override;
 
     private:
         ABS_t ABSFunction;
         token_t tokens_in_x[1];
         token_t tokens_in_y[1];
-
-        bool datadependentdelay;
+        int     iteration;  // Number of printed pixels
 };
 
 void ABS::Initialize()
@@ -255,44 +210,46 @@ void ABS::Initialize()
     this->ABSFunction = (ABS_t) this->Actor::application->LoadActor("ABS");
     if(this->ABSFunction == nullptr)
         throw std::runtime_error("Cannot load ABS function");
-
-    if(this->datadependentdelay)
-        std::cerr << "\e[1;33mWARNING:\e[0m Data Dependent Delays only represent MicroBlazes with Extended ALU.\e[0m\n";
+}
+void ABS::SaveState(std::ostream &state) const
+{
+    this->Actor::SaveState(state);
+    state::Write<int32_t>(state, this->iteration);
+}
+void ABS::LoadState(std::istream &state)
+{
+    this->Actor::LoadState(state);
+    this->iteration = state::Read<int32_t>(state);
 }
 void ABS::ReadPhase()
 {
     this->channels_in[0]->ReadTokens(this->tokens_in_x);
     this->channels_in[1]->ReadTokens(this->tokens_in_y);
 }
+// The delay depends on the number of negative inputs (0, 1 or 2)
+size_t ABS::DelayKey()
+{
+    bool neg1 = this->tokens_in_x[0] < 0;
+    bool neg2 = this->tokens_in_y[0] < 0;
+    return neg1 + neg2;
+}
+size_t ABS::DelayKeyCount() const
+{
+    return 3;
+}
 void ABS::ComputePhase()
 {
-    if(this->datadependentdelay)
-    {
-        bool neg1 = this->tokens_in_x[0] < 0;
-        bool neg2 = this->tokens_in_y[0] < 0;
-
-        if(neg1 and neg2)
-            sc_core::wait(sc_core::sc_time(71, sc_core::SC_NS));
-        else if(neg1 or neg2)
-            sc_core::wait(sc_core::sc_time(62, sc_core::SC_NS));
-        else
-            sc_core::wait(sc_core::sc_time(53, sc_core::SC_NS));
-    }
-    else
-    {
-        sc_core::wait(this->delayvector->GetDelay());
-    }
+    sc_core::wait(this->GetComputeDelay());
 
     token_t result;
     result = this->ABSFunction(this->tokens_in_x, this->tokens_in_y);
     
     const  int image_width  = 48;
     const  int image_height = 48;
-    static int iteration;
 
     auto output = std::to_string(result);
-    iteration++;
-    if((iteration)%image_width == 0)
+    this->iteration++;
+    if((this->iteration)%image_width == 0)
         output += "\n";
     else
         output += ", ";
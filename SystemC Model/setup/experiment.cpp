@@ -160,6 +160,12 @@ std::tuple<DISTRIBUTION, bool, COMMUNICATIONMODEL> Experiment::LoadModels()
         computationmodel = DISTRIBUTION::AVERAGE;
     else if(strcmp(computationmodelname, "gaussian KDE") == 0)
         computationmodel = DISTRIBUTION::GAUSSIAN_KDE;
+    else if(strcmp(computationmodelname, "empirical distribution") == 0)
+        computationmodel = DISTRIBUTION::EMPIRICAL;
+    else if(strcmp(computationmodelname, "empirical KDE") == 0)
+        computationmodel = DISTRIBUTION::EMPIRICAL_KDE;
+    else if(strcmp(computationmodelname, "parametric fit") == 0)
+        computationmodel = DISTRIBUTION::PARAMETRIC;
     else
     {
         std::cerr << "\e[1;31mERROR:\e[0m Invalid computation model \""
@@ -193,6 +199,104 @@ std::tuple<DISTRIBUTION, bool, COMMUNICATIONMODEL> Experiment::LoadModels()
 
 
 
+// The optional attributes arbitration and slot of the <communication> element
+// select the bus arbitration policy:
+// <communication arbitration="time division" slot="100">cycle accurate</communication>
+// The slot length is given in ns and only required for TDMA.
+// Without the arbitration attribute (or with arbitration="none"), the initiators do not wait for each other
+// and only the contention penalties get applied, like in the original model.
+// The other policies serialize the bus accesses and change the simulated durations.
+// A missing <communication> element gets reported by LoadModels, so the defaults get used then.
+// Only invalid attribute values throw.
+std::tuple<ARBITRATIONPOLICY, sc_core::sc_time> Experiment::LoadArbitrationPolicy()
+{
+    ARBITRATIONPOLICY policy = ARBITRATIONPOLICY::NONE;
+    sc_core::sc_time  slot   = sc_core::SC_ZERO_TIME;
+
+    XMLElement *communicationnode = nullptr;
+    if(this->modelsnode != nullptr)
+        communicationnode = this->modelsnode->FirstChildElement("communication");
+    if(communicationnode == nullptr)
+        return std::make_tuple(policy, slot);
+
+    const char *arbitrationattribute = communicationnode->Attribute("arbitration");
+    if(arbitrationattribute == nullptr)
+    {
+        if(communicationnode->Attribute("slot") != nullptr)
+            std::cerr << "\e[1;33mWARNING:\e[0m The slot attribute is only used with arbitration=\"time division\"\n";
+        return std::make_tuple(policy, slot);
+    }
+
+    if(strcmp(arbitrationattribute, "none") == 0)
+        policy = ARBITRATIONPOLICY::NONE;
+    else if(strcmp(arbitrationattribute, "first come first serve") == 0)
+        policy = ARBITRATIONPOLICY::FCFS;
+    else if(strcmp(arbitrationattribute, "round robin") == 0)
+        policy = ARBITRATIONPOLICY::ROUNDROBIN;
+    else if(strcmp(arbitrationattribute, "fixed priority") == 0)
+        policy = ARBITRATIONPOLICY::FIXEDPRIORITY;
+    else if(strcmp(arbitrationattribute, "time division") == 0)
+        policy = ARBITRATIONPOLICY::TDMA;
+    else
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Invalid arbitration policy \""
+                  << arbitrationattribute << "\" "
+                  << "in element <experiment><models><communication>!\n";
+        throw std::runtime_error("Loading experiment configuration failed!");
+    }
+
+    if(policy != ARBITRATIONPOLICY::TDMA and communicationnode->Attribute("slot") != nullptr)
+        std::cerr << "\e[1;33mWARNING:\e[0m The slot attribute is only used with arbitration=\"time division\"\n";
+
+    if(policy == ARBITRATIONPOLICY::TDMA)
+    {
+        unsigned int slotlength;
+        if(communicationnode->QueryUnsignedAttribute("slot", &slotlength) != XML_SUCCESS or slotlength == 0)
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m Loading experiment failed. "
+                      << "TDMA arbitration requires a slot attribute greater than 0 in element <experiment><models><communication>!\n";
+            throw std::runtime_error("Loading experiment configuration failed!");
+        }
+        slot = sc_core::sc_time(slotlength, sc_core::SC_NS);
+    }
+
+    return std::make_tuple(policy, slot);
+}
+
+
+
+// A missing <computation> element gets reported by LoadModels, so the family gets selected automatically then.
+// Only an invalid family attribute throws.
+FAMILY Experiment::LoadParametricFamily()
+{
+    XMLElement *computationnode = nullptr;
+    if(this->modelsnode != nullptr)
+        computationnode = this->modelsnode->FirstChildElement("computation");
+    if(computationnode == nullptr)
+        return FAMILY::AUTOMATIC;
+
+    const char *familyattribute = computationnode->Attribute("family");
+    if(familyattribute == nullptr or strcmp(familyattribute, "automatic") == 0)
+        return FAMILY::AUTOMATIC;
+    else if(strcmp(familyattribute, "lognormal") == 0)
+        return FAMILY::LOGNORMAL;
+    else if(strcmp(familyattribute, "gamma") == 0)
+        return FAMILY::GAMMA;
+    else if(strcmp(familyattribute, "weibull") == 0)
+        return FAMILY::WEIBULL;
+    else if(strcmp(familyattribute, "shifted exponential") == 0)
+        return FAMILY::SHIFTEDEXPONENTIAL;
+    else if(strcmp(familyattribute, "gaussian mixture") == 0)
+        return FAMILY::GAUSSIANMIXTURE;
+
+    std::cerr << "\e[1;31mERROR:\e[0m Invalid distribution family \""
+              << familyattribute << "\" "
+              << "in element <experiment><models><computation>!\n";
+    throw std::runtime_error("Loading experiment configuration failed!");
+}
+
+
+
 bool Experiment::LoadApplication(SDFApplication *application)
 {
     // Load code and data paths
@@ -376,6 +480,42 @@ bool Experiment::LoadActorMapping(TileMap &tilemap, ActorMap &actormap)
 
 
 
+// Same selection of the feature as in LoadActorMapping
+std::vector<std::pair<std::string, std::string>> Experiment::LoadActorFeatures()
+{
+    std::vector<std::pair<std::string, std::string>> actorfeatures;
+    if(this->actormappingnode == nullptr)
+        return actorfeatures;
+
+    for(XMLElement *tilenode = this->actormappingnode->FirstChildElement("tile");
+        tilenode != nullptr;
+        tilenode = tilenode->NextSiblingElement("tile"))
+    {
+        const char *tilefeature = tilenode->Attribute("feature");
+
+        for(XMLElement *actornode = tilenode->FirstChildElement("actor");
+            actornode != nullptr;
+            actornode = actornode->NextSiblingElement("actor"))
+        {
+            const char *actorname    = actornode->GetText();
+            const char *actorfeature = actornode->Attribute("feature");
+            if(actorname == nullptr)
+                continue;
+
+            if(actorfeature != nullptr)
+                actorfeatures.emplace_back(actorname, actorfeature);
+            else if(tilefeature != nullptr)
+                actorfeatures.emplace_back(actorname, tilefeature);
+            else
+                actorfeatures.emplace_back(actorname, "none");
+        }
+    }
+
+    return actorfeatures;
+}
+
+
+
 bool Experiment::LoadChannelMapping(MemoryMap &memorymap, TileMap &tilemap, ChannelMap &channelmap)
 {
     if(this->channelmappingnode == nullptr)
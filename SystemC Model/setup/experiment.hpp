@@ -2,6 +2,8 @@
 #define EXPERIMENTSETUP_HPP
 
 #include <tuple>
+#include <utility>
+#include <vector>
 #include <unordered_map>
 #include <tinyxml2.h>
 
@@ -9,6 +11,7 @@
 #include <software/channel.hpp>
 #include <hardware/tile.hpp>
 #include <hardware/memory.hpp>
+#include <hardware/axiinterconnect.hpp>
 #include <setup/sdfapplication.hpp>
 
 using namespace tinyxml2;
@@ -25,8 +28,12 @@ class Experiment
         ~Experiment();
 
         std::tuple<DISTRIBUTION, bool, COMMUNICATIONMODEL> LoadModels();
+        std::tuple<ARBITRATIONPOLICY, sc_core::sc_time> LoadArbitrationPolicy();
+        FAMILY LoadParametricFamily();
         bool LoadApplication(SDFApplication *application);
         bool LoadActorMapping(TileMap &tilemap, ActorMap &actormap);
+        // Names and features of the mapped actors, without creating any actor or tile
+        std::vector<std::pair<std::string, std::string>> LoadActorFeatures();
         bool LoadChannelMapping(MemoryMap &memorymap, TileMap &tilemap, ChannelMap &channelmap);
 
     private:
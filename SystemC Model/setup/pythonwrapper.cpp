@@ -4,8 +4,18 @@
 #include <iostream>
 
 
+std::atomic<bool> PythonWrapper::started(false);
+
+bool PythonWrapper::IsStarted()
+{
+    return PythonWrapper::started;
+}
+
+
+
 PythonWrapper::PythonWrapper()
 {
+    PythonWrapper::started = true;
     this->threadstate.datapath    = nullptr;
     this->threadstate.returnvalue = nullptr;
     this->threadstate.call        = false;
@@ -35,7 +45,7 @@ void PythonWrapper::ForceShutdown()
 }
 
 
-int PythonWrapper::GaussianKDE(std::vector<double> *samples, std::string &datapath)
+int PythonWrapper::GaussianKDE(std::vector<double> *samples, const std::string &datapath)
 {
     // Request access
     std::lock_guard<std::mutex> guard(this->access);
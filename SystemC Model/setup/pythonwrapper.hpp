@@ -25,8 +25,12 @@ class PythonWrapper
         ~PythonWrapper();
         void ForceShutdown();
 
+        // The Python thread starts with the first call of GetInstance.
+        // This allows to shut it down only if it was necessary at all.
+        static bool IsStarted();
+
         // Python Functions
-        int GaussianKDE(std::vector<double> *samples, std::string &datapath);
+        int GaussianKDE(std::vector<double> *samples, const std::string &datapath);
 
     private:
         void PythonThread();
@@ -42,13 +46,14 @@ class PythonWrapper
             const char *functionname;   // Set by function
 
             // GaussianKDE parameters
-            std::string *datapath;            // Input for the function
+            const std::string *datapath;      // Input for the function
             std::vector<double> *returnvalue; // The underlying vector gets updated in the thread 
                                               // with the returned data.
                                               // In case of an error, the pointer gets replaced by nullptr
         } threadstate;
         std::thread pythonthread;
 
+        static std::atomic<bool> started;
 };
 
 #endif
@@ -1,5 +1,11 @@
 #include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <link.h>
 #include <setup/sdfapplication.hpp>
+#include <statestream.hpp>
 
 
 SDFApplication::SDFApplication()
@@ -33,6 +39,7 @@ bool SDFApplication::LoadApplication(const char *codepath, const char *datapath)
                 << "\e[0m\n";
             return false;
         }
+        this->CaptureDataSegments(this->datahandler);
     }
 
     this->codehandler = dlopen(codepath, RTLD_LAZY);
@@ -43,12 +50,141 @@ bool SDFApplication::LoadApplication(const char *codepath, const char *datapath)
             << "\e[0m\n";
         return false;
     }
+    this->CaptureDataSegments(this->codehandler);
 
     return true;
 }
 
 
 
+// Address ranges of the writable segments of the object loaded at base
+struct SegmentSearch
+{
+    ElfW(Addr) base;
+    std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+};
+
+static int FindWritableSegments(struct dl_phdr_info *info, size_t, void *data)
+{
+    SegmentSearch *search = static_cast<SegmentSearch*>(data);
+    if(info->dlpi_addr != search->base)
+        return 0;
+
+    // The dynamic linker write protects the RELRO part after relocating it
+    uintptr_t relrobegin = 0;
+    uintptr_t relroend   = 0;
+    for(int i = 0; i < info->dlpi_phnum; i++)
+    {
+        if(info->dlpi_phdr[i].p_type != PT_GNU_RELRO)
+            continue;
+        relrobegin = info->dlpi_addr + info->dlpi_phdr[i].p_vaddr;
+        relroend   = relrobegin + info->dlpi_phdr[i].p_memsz;
+    }
+
+    for(int i = 0; i < info->dlpi_phnum; i++)
+    {
+        const ElfW(Phdr) &header = info->dlpi_phdr[i];
+        if(header.p_type != PT_LOAD or not (header.p_flags & PF_W))
+            continue;
+
+        uintptr_t begin = info->dlpi_addr + header.p_vaddr;
+        uintptr_t end   = begin + header.p_memsz;
+        if(relrobegin < end and relroend > begin)
+        {
+            if(relrobegin > begin)
+                search->ranges.emplace_back(begin, relrobegin);
+            begin = std::max(begin, relroend);
+        }
+        if(begin < end)
+            search->ranges.emplace_back(begin, end);
+    }
+    return 1;
+}
+
+void SDFApplication::CaptureDataSegments(void *handler)
+{
+    struct link_map *map;
+    if(dlinfo(handler, RTLD_DI_LINKMAP, &map) != 0)
+    {
+        std::cerr << "\e[1;33mWARNING:\e[0m Cannot find the data segments of the SDF Application. "
+                  << "\e[1;30m(Checkpoints will not contain the static variables of the kernels)\e[0m\n";
+        return;
+    }
+
+    SegmentSearch search;
+    search.base = map->l_addr;
+    dl_iterate_phdr(FindWritableSegments, &search);
+
+    for(const auto &range : search.ranges)
+    {
+        DataSegment segment;
+        segment.address = reinterpret_cast<unsigned char*>(range.first);
+        segment.initial.assign(segment.address, reinterpret_cast<unsigned char*>(range.second));
+        this->datasegments.push_back(std::move(segment));
+    }
+}
+
+
+
+// Each segment gets stored as list of runs of changed bytes: offset, length, bytes
+void SDFApplication::SaveState(std::ostream &state) const
+{
+    state::Write<uint64_t>(state, this->datasegments.size());
+    for(const DataSegment &segment : this->datasegments)
+    {
+        size_t size = segment.initial.size();
+        std::vector<std::pair<uint64_t, uint64_t>> runs;
+        for(size_t offset = 0; offset < size; offset++)
+        {
+            if(segment.address[offset] == segment.initial[offset])
+                continue;
+
+            size_t end = offset;
+            while(end < size and segment.address[end] != segment.initial[end])
+                end++;
+            runs.emplace_back(offset, end - offset);
+            offset = end;
+        }
+
+        state::Write<uint64_t>(state, size);
+        state::Write<uint64_t>(state, runs.size());
+        for(const auto &run : runs)
+        {
+            state::Write<uint64_t>(state, run.first);
+            state::Write<uint64_t>(state, run.second);
+            state.write(reinterpret_cast<const char*>(segment.address + run.first), run.second);
+        }
+    }
+}
+
+void SDFApplication::LoadState(std::istream &state)
+{
+    if(state::Read<uint64_t>(state) != this->datasegments.size())
+        throw std::runtime_error("Checkpoint does not match the data segments of the SDF Application");
+
+    for(const DataSegment &segment : this->datasegments)
+    {
+        size_t size = segment.initial.size();
+        if(state::Read<uint64_t>(state) != size)
+            throw std::runtime_error("Checkpoint does not match the data segments of the SDF Application");
+
+        std::copy(segment.initial.begin(), segment.initial.end(), segment.address);
+
+        uint64_t runs = state::Read<uint64_t>(state);
+        for(uint64_t run = 0; run < runs; run++)
+        {
+            uint64_t offset = state::Read<uint64_t>(state);
+            uint64_t length = state::Read<uint64_t>(state);
+            if(offset + length > size)
+                throw std::runtime_error("Checkpoint does not match the data segments of the SDF Application");
+            if(not state.read(reinterpret_cast<char*>(segment.address + offset), length))
+                throw std::runtime_error("Checkpoint is truncated");
+        }
+    }
+}
+
+
+
 void* SDFApplication::LoadActor(const char *actorname) noexcept
 {
     if(not this->codehandler)
@@ -117,6 +253,7 @@ void SDFApplication::CloseApplication() noexcept
     // Ensure defined data
     this->datahandler = nullptr;
     this->codehandler = nullptr;
+    this->datasegments.clear();
 }
 
 // vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -1,6 +1,9 @@
 #ifndef SDFAPPLICATION_HPP
 #define SDFAPPLICATION_HPP
 #include <dlfcn.h>
+#include <istream>
+#include <ostream>
+#include <vector>
 
 class SDFApplication
 {
@@ -12,11 +15,26 @@ class SDFApplication
         void* LoadActor(const char *actorname ) noexcept;
         void* LoadData (const char *symbolname) noexcept;
 
+        // Static variables of the application's kernels for checkpoints.
+        // The writable data segments get stored as difference to their contents right after loading.
+        // So pointers the dynamic linker relocated stay valid when the objects get loaded at a different address,
+        // as long as the kernels do not store pointers themselves.
+        void SaveState(std::ostream &state) const;
+        void LoadState(std::istream &state);
+
     private:
         void CloseApplication() noexcept;
+        void CaptureDataSegments(void *handler);
+
+        struct DataSegment
+        {
+            unsigned char             *address;
+            std::vector<unsigned char> initial;  // Contents after loading
+        };
 
         void* datahandler;
         void* codehandler;
+        std::vector<DataSegment> datasegments;
 };
 
 #endif
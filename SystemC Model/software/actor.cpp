@@ -1,12 +1,19 @@
 #include <iostream>
+#include <algorithm>
 
 #include <software/actor.hpp>
+#include <hardware/tile.hpp>
+#include <statestream.hpp>
 
 Actor::Actor(std::string name, DelayVectorMap &delaymap, Monitor &monitor, SDFApplication &application)
     : name(name)
+    , delaytable(nullptr)
     , application(&application)
-    , delayvectormap(&delaymap)
     , monitor(&monitor)
+    , delayvectormap(&delaymap)
+    , delaytablemap(nullptr)
+    , tile(nullptr)
+    , tracesignal(monitor.RegisterSignal(name))
     , isstartactor(false)
     , isfinishactor(false)
 {
@@ -58,6 +65,22 @@ void Actor::ChangeTile(Tile *tile)
 
 
 
+bool Actor::IsMapped() const
+{
+    return this->tile != nullptr;
+}
+
+
+
+DelayVector* Actor::GetDelayVector() const
+{
+    if(this->delaytable != nullptr)
+        return nullptr;
+    return this->delayvector;
+}
+
+
+
 void Actor::SelectFeature(std::string feature)
 {
     if(this->delayvectormap == nullptr)
@@ -69,6 +92,10 @@ void Actor::SelectFeature(std::string feature)
         throw std::runtime_error("No DelayVectorMap available");
     }
 
+    this->feature = feature;
+    if(this->delaytablemap != nullptr)
+        this->SelectDelayTable();
+
     try
     {
         this->delayvector = this->delayvectormap->at(feature);
@@ -86,6 +113,76 @@ void Actor::SelectFeature(std::string feature)
 
 
 
+void Actor::UseDelayTables(DelayTableMap &delaytablemap)
+{
+    this->delaytablemap = &delaytablemap;
+    this->SelectDelayTable();
+}
+
+
+
+// Not all features may be characterized.
+// Then the table of the architecture without special features gets used,
+// or any other available table if this one is missing as well.
+void Actor::SelectDelayTable()
+{
+    std::vector<std::string> candidates = {this->feature, "none"};
+    std::vector<std::string> others;
+    for(const auto &entry : *this->delaytablemap)
+        others.push_back(entry.first);
+    std::sort(others.begin(), others.end());
+    candidates.insert(candidates.end(), others.begin(), others.end());
+
+    for(const std::string &candidate : candidates)
+    {
+        auto entry = this->delaytablemap->find(candidate);
+        if(entry == this->delaytablemap->end() or not entry->second->Load())
+            continue;
+
+        if(candidate != this->feature)
+            std::cerr << "\e[1;33mWARNING:\e[0m No data dependent delays for feature "
+                      << this->feature << " of actor " << this->name
+                      << ". \e[1;30m(Using " << entry->second->GetPath() << " instead)\e[0m\n";
+
+        if(entry->second->Size() < this->DelayKeyCount())
+        {
+            std::cerr << "\e[1;31mERROR:\e[0m Delay table " << entry->second->GetPath()
+                      << " has " << entry->second->Size() << " keys, but actor " << this->name
+                      << " needs " << this->DelayKeyCount() << "!\n";
+            throw std::runtime_error("Delay table does not cover all keys of the actor");
+        }
+
+        this->delaytable = entry->second;
+        return;
+    }
+
+    std::cerr << "\e[1;31mERROR:\e[0m No delay table available for actor " << this->name << "!\n";
+    throw std::runtime_error("No delay table available");
+}
+
+
+
+sc_core::sc_time Actor::GetComputeDelay()
+{
+    if(this->delaytable != nullptr)
+        return this->delaytable->GetDelay(this->DelayKey());
+    return this->delayvector->GetDelay();
+}
+
+
+
+size_t Actor::DelayKey()
+{
+    return 0;
+}
+
+size_t Actor::DelayKeyCount() const
+{
+    return 1;
+}
+
+
+
 Actor& Actor::operator<< (Channel &incoming)
 {
     this->channels_in.push_back(&incoming);
@@ -101,25 +198,30 @@ Actor& Actor::operator>> (Channel &outgoing)
 }
 
 
-void Actor::TracePhase(const char* phase)
+void Actor::TracePhase(TRACEPHASE phase)
 {
     if(not this->monitor)
         return;
 
-    this->monitor->ExpandTrace(this->name, phase);
+    this->monitor->ExpandTrace(this->tracesignal, phase);
 }
 
 void Actor::Execute()
 {
+    // Time stamps of the monitor and waits inside the compute phase
+    // require the local time of a temporal decoupled tile to be synchronized.
     if(this->monitor != NULL and this->isstartactor == true)
+    {
+        this->tile->Synchronize();
         this->monitor->IterationBegin();
+    }
 
     // during ReadPhase and WritePhase there are lots of array accesses
     // to the channels_out and channels_in vector.
     // This can easily cause an out_of_range error.
     try 
     {
-        this->TracePhase("read");
+        this->TracePhase(TRACEPHASE::ACTOR_READ);
         this->ReadPhase();
     }
     catch (const std::out_of_range& oor)
@@ -127,12 +229,13 @@ void Actor::Execute()
         std::cerr << "Out of Range error during read phase of " << this->name << ": " << oor.what() << '\n';
     }
 
-    this->TracePhase("compute");
+    this->tile->Synchronize();
+    this->TracePhase(TRACEPHASE::ACTOR_COMPUTE);
     this->ComputePhase();
 
     try 
     {
-        this->TracePhase("write");
+        this->TracePhase(TRACEPHASE::ACTOR_WRITE);
         this->WritePhase();
     }
     catch (const std::out_of_range& oor)
@@ -140,7 +243,8 @@ void Actor::Execute()
         std::cerr << "Out of Range error during write phase of " << this->name << ": " << oor.what() << '\n';
     }
 
-    this->TracePhase("idle");
+    this->tile->Synchronize();
+    this->TracePhase(TRACEPHASE::ACTOR_IDLE);
 
     if(this->monitor != NULL and this->isfinishactor == true)
         this->monitor->IterationEnd();
@@ -154,6 +258,18 @@ void Actor::Initialize()
 
 
 
+void Actor::SaveState(std::ostream &state) const
+{
+    state::WriteString(state, this->name);
+}
+
+void Actor::LoadState(std::istream &state)
+{
+    state::ExpectString(state, this->name);
+}
+
+
+
 void Actor::ReadPhase()
 {
 }
@@ -3,9 +3,12 @@
 
 #include <string>
 #include <iostream>
+#include <istream>
+#include <ostream>
 
 #include <core/master.hpp>
 #include <delayvector.hpp>
+#include <delaytable.hpp>
 #include <software/channel.hpp>
 #include <monitor.hpp>
 #include <setup/sdfapplication.hpp>
@@ -20,6 +23,13 @@ class Actor
 
         void ChangeTile(Tile *tile);
         void SelectFeature(std::string feature);
+
+        // Use data dependent delays instead of the delay vectors.
+        // The map provides a delay table for each feature.
+        void UseDelayTables(DelayTableMap &delaytablemap);
+
+        bool IsMapped() const;  // true if the actor got mapped onto a tile
+        DelayVector* GetDelayVector() const;    // Delay vector of the selected feature, nullptr if delay tables are used
     
         Actor& operator<< (Channel &incoming); 
         Actor& operator>> (Channel &outgoing); 
@@ -27,24 +37,43 @@ class Actor
         virtual void Initialize();
         void Execute();
 
+        // State the actor keeps from one firing to the next, for checkpoints.
+        // Tokens are stored in the channels and do not belong to it.
+        virtual void SaveState(std::ostream &state) const;
+        virtual void LoadState(std::istream &state);
+
     protected:
 
         virtual void ReadPhase();
         virtual void ComputePhase() = 0;
         virtual void WritePhase();
 
+        // Delay of the compute phase: From the delay table, if data dependent delays are used,
+        // otherwise from the delay vector.
+        sc_core::sc_time GetComputeDelay();
+
+        // Key of the data dependent delay, computed from the input tokens (default: 0)
+        virtual size_t DelayKey();
+        // Number of keys DelayKey can return. A delay table must cover all of them.
+        virtual size_t DelayKeyCount() const;
+
         std::string name;
         DelayVector *delayvector;
+        DelayTable  *delaytable;    // nullptr if no data dependent delays are used
         SDFApplication *application;
         std::vector<Channel*> channels_out;
         std::vector<Channel*> channels_in;
         Monitor *monitor;
 
     private:
-        void TracePhase(const char* phase);
+        void TracePhase(TRACEPHASE phase);
+        void SelectDelayTable();
 
         DelayVectorMap *delayvectormap;
+        DelayTableMap  *delaytablemap;
+        std::string feature;
         Tile    *tile;      // The tile this actor gets executed on
+        TraceSignal tracesignal;
         bool    isstartactor;
         bool    isfinishactor;
 };
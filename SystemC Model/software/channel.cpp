@@ -2,6 +2,7 @@
 
 #include <software/channel.hpp>
 #include <hardware/tile.hpp>
+#include <statestream.hpp>
 
 
 Channel::Channel(std::string name, unsigned int prate, unsigned int crate, unsigned int size, Monitor &monitor, COMMUNICATIONMODEL model)
@@ -16,7 +17,12 @@ Channel::Channel(std::string name, unsigned int prate, unsigned int crate, unsig
             , consumertile(NULL)
             , producertile(NULL)
             , monitor(&monitor)
+            , tracesignal(monitor.RegisterSignal(name))
             , model(model)
+            , pollingfastforward(false)
+            , usagevalue(0)
+            , usageupdatetime(sc_core::SC_ZERO_TIME)
+            , usagesampletime(sc_core::SC_ZERO_TIME)
 {
 };
 
@@ -42,12 +48,51 @@ void Channel::ChangeProducerTile(Tile *tile)
 
 
 
-void Channel::TracePhase(const char* phase)
+void Channel::EnablePollingFastForward(bool enable)
+{
+    this->pollingfastforward = enable;
+}
+
+
+
+void Channel::UsageSampled(sc_core::sc_time time)
+{
+    this->usagesampletime = time;
+}
+
+void Channel::UsageUpdated(unsigned long usage, sc_core::sc_time time)
+{
+    this->usagevalue      = usage;
+    this->usageupdatetime = time;
+    this->usageevent.notify();
+}
+
+
+
+void Channel::SaveState(std::ostream &state) const
+{
+    state::WriteString(state, this->name);
+    state::Write<uint64_t>(state, this->usagevalue);
+    state::Write<sc_dt::uint64>(state, this->usageupdatetime.value());
+    state::Write<sc_dt::uint64>(state, this->usagesampletime.value());
+}
+
+void Channel::LoadState(std::istream &state)
+{
+    state::ExpectString(state, this->name);
+    this->usagevalue      = state::Read<uint64_t>(state);
+    this->usageupdatetime = sc_core::sc_time::from_value(state::Read<sc_dt::uint64>(state));
+    this->usagesampletime = sc_core::sc_time::from_value(state::Read<sc_dt::uint64>(state));
+}
+
+
+
+void Channel::TracePhase(TRACEPHASE phase)
 {
     if(not this->monitor)
         return;
 
-    this->monitor->ExpandTrace(this->name, phase);
+    this->monitor->ExpandTrace(this->tracesignal, phase);
 }
 
 
@@ -102,51 +147,34 @@ void Channel::WriteTokens(token_t tokens[])
 void Channel::ReadTokensCycleAccurate(token_t tokens[])
 {
     // Initialization Block
-    this->TracePhase("R:init.");
+    this->TracePhase(TRACEPHASE::CHANNEL_READINIT);
     unsigned int usage;
-    sc_core::wait(1, sc_core::SC_NS);
+    this->consumertile->Wait(sc_core::sc_time(1, sc_core::SC_NS));
 
     // Polling Block
-    this->TracePhase("R:polling");
-    do
-    {
-        this->consumertile->ReadWord(this->usageaddress, &usage);
-
-        sc_core::wait(1, sc_core::SC_NS);
-        if(usage != 0)
-            break;
-        sc_core::wait(2, sc_core::SC_NS);
-    }
-    while(true);
+    this->TracePhase(TRACEPHASE::CHANNEL_READPOLLING);
+    this->PollCycleAccurate(this->consumertile, true);
 
     // Preparation Block
-    this->TracePhase("R:prep.");
-    unsigned int index;
-    index = 0;
-    sc_core::wait(5, sc_core::SC_NS);
+    this->TracePhase(TRACEPHASE::CHANNEL_READPREPARE);
+    this->consumertile->Wait(sc_core::sc_time(5, sc_core::SC_NS));
 
     // Copy Block
-    this->TracePhase("R:copying");
-    for(unsigned int tokenindex = 0; tokenindex < this->consumerate; tokenindex++)
-    {
-        unsigned long long address;
-        address  = this->fifoaddress;
-        address += index;
-        this->consumertile->ReadWord(address, reinterpret_cast< unsigned int* >(&tokens[tokenindex]));
-        index   += 1;
-
-        sc_core::wait(5, sc_core::SC_NS);
-        if(tokenindex+1 < this->consumerate)
-            sc_core::wait(2, sc_core::SC_NS);
-    }
-    sc_core::wait(1, sc_core::SC_NS);
+    // Each token read is followed by 5 cycles, plus 2 cycles between two tokens
+    this->TracePhase(TRACEPHASE::CHANNEL_READCOPYING);
+    this->consumertile->ReadBurst(this->fifoaddress,
+            reinterpret_cast< unsigned int* >(tokens),
+            this->consumerate,
+            sc_core::sc_time(5 + 2, sc_core::SC_NS));
+    this->consumertile->Wait(sc_core::sc_time(5, sc_core::SC_NS));
+    this->consumertile->Wait(sc_core::sc_time(1, sc_core::SC_NS));
 
     // Update meta data
-    this->TracePhase("R:manag.");
+    this->TracePhase(TRACEPHASE::CHANNEL_READMANAGE);
     usage = 0;
     this->consumertile->WriteWord(this->usageaddress, &usage);
-    sc_core::wait(3, sc_core::SC_NS);
-    this->TracePhase("idle");
+    this->consumertile->Wait(sc_core::sc_time(3, sc_core::SC_NS));
+    this->TracePhase(TRACEPHASE::CHANNEL_IDLE);
 }
 
 
@@ -154,49 +182,177 @@ void Channel::ReadTokensCycleAccurate(token_t tokens[])
 void Channel::WriteTokensCycleAccurate(token_t tokens[])
 {
     // Initialization Block
-    this->TracePhase("W:init.");
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEINIT);
     unsigned int usage;
-    sc_core::wait(1, sc_core::SC_NS);
+    this->producertile->Wait(sc_core::sc_time(1, sc_core::SC_NS));
 
     // Polling Block
-    this->TracePhase("W:polling");
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEPOLLING);
+    this->PollCycleAccurate(this->producertile, false);
+
+    // Preparation Block
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEPREPARE);
+    this->producertile->Wait(sc_core::sc_time(4, sc_core::SC_NS));
+
+    // Copy Block
+    // Each token write is preceded by 2 cycles and followed by 5 cycles
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITECOPYING);
+    this->producertile->Wait(sc_core::sc_time(2, sc_core::SC_NS));
+    this->producertile->WriteBurst(this->fifoaddress,
+            reinterpret_cast< unsigned int* >(tokens),
+            this->producerate,
+            sc_core::sc_time(5 + 2, sc_core::SC_NS));
+    this->producertile->Wait(sc_core::sc_time(5, sc_core::SC_NS));
+    
+    // Management Block
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEMANAGE);
+    usage = 1;
+    this->producertile->WriteWord(this->usageaddress, &usage);
+    this->producertile->Wait(sc_core::sc_time(3, sc_core::SC_NS));
+
+    this->TracePhase(TRACEPHASE::CHANNEL_IDLE);
+}
+
+
+
+void Channel::PollCycleAccurate(Tile *tile, bool waitforfull)
+{
+    bool          shared       = not tile->IsPrivateAddress(this->usageaddress);
+    Interconnect *interconnect = shared ? tile->GetInterconnect() : nullptr;
+
+    unsigned int usage;
     do
     {
-        this->producertile->ReadWord(this->usageaddress, &usage);
-        sc_core::wait(1, sc_core::SC_NS);
-        if(usage == 0)
+        // Fast-forward needs to know if this round overlapped with other transactions.
+        // ReadWord synchronizes before the bus access anyway.
+        bool          undisturbed  = false;
+        sc_dt::uint64 transactions = 0;
+        if(this->pollingfastforward and interconnect)
+        {
+            tile->Synchronize();
+            undisturbed  = interconnect->AllowsPollingFastForward();
+            transactions = interconnect->GetTransactionCount();
+        }
+
+        sc_core::sc_time roundstart = tile->GetCurrentTime();
+        tile->ReadWord(this->usageaddress, &usage);
+        sc_core::sc_time readtime   = tile->GetCurrentTime() - roundstart;
+        sc_core::sc_time sampleoffset = sc_core::SC_ZERO_TIME;
+        if(this->usagesampletime > roundstart)
+            sampleoffset = this->usagesampletime - roundstart;
+        if(interconnect)
+            undisturbed = undisturbed and interconnect->GetTransactionCount() == transactions + 1;
+
+        tile->Wait(sc_core::sc_time(1, sc_core::SC_NS));
+        if((usage != 0) == waitforfull)
             break;
-        sc_core::wait(2, sc_core::SC_NS);
-
+        tile->Wait(sc_core::sc_time(2, sc_core::SC_NS));
+
+        if(not this->pollingfastforward)
+            continue;
+
+        sc_core::sc_time period = tile->GetCurrentTime() - roundstart;
+        if(not shared)
+            this->FastForwardPrivatePolling(tile, waitforfull, tile->GetCurrentTime(), period, sampleoffset);
+        else if(undisturbed
+            and this->FastForwardSharedPolling(tile, interconnect, period, readtime, sampleoffset, usage))
+        {
+            // Finish the polling round that was in progress when the fast-forward ended
+            tile->Wait(sc_core::sc_time(1, sc_core::SC_NS));
+            if((usage != 0) == waitforfull)
+                break;
+            tile->Wait(sc_core::sc_time(2, sc_core::SC_NS));
+        }
     }
     while(true);
+}
 
-    // Preparation Block
-    this->TracePhase("W:prep.");
-    unsigned int index;
-    index = 0;
-    sc_core::wait(4, sc_core::SC_NS);
 
-    // Copy Block
-    this->TracePhase("W:copying");
-    for(unsigned int tokenindex = 0; tokenindex < this->producerate; tokenindex++)
+
+// The flag is in the private memory of the polling tile. The polling rounds do not interact with other tiles.
+void Channel::FastForwardPrivatePolling(Tile *tile, bool waitforfull, sc_core::sc_time roundstart, sc_core::sc_time period, sc_core::sc_time sampleoffset)
+{
+    // Polling the usage flag has no side effects.
+    // So instead of simulating each polling round, wait until the flag changes.
+    tile->Synchronize();
+    while((this->usagevalue != 0) != waitforfull)
+        sc_core::wait(this->usageevent);
+
+    // Polling round k starts at roundstart + k·period and samples the flag
+    // at roundstart + k·period + sampleoffset.
+    // Find the first round that samples the flag after it was updated.
+    // That round must not start in the past.
+    sc_dt::uint64 start   = roundstart.value();
+    sc_dt::uint64 length  = period.value();
+    sc_dt::uint64 offset  = sampleoffset.value();
+    sc_dt::uint64 update  = this->usageupdatetime.value();
+    sc_dt::uint64 now     = sc_core::sc_time_stamp().value();
+    sc_dt::uint64 rounds  = 0;
+
+    if(update > start + offset)
+        rounds = (update - start - offset + length - 1) / length;
+    if(start + rounds * length < now)
+        rounds = (now - start + length - 1) / length;
+
+    sc_core::sc_time resume = sc_core::sc_time::from_value(start + rounds * length);
+    if(resume > sc_core::sc_time_stamp())
+        sc_core::wait(resume - sc_core::sc_time_stamp());
+
+    // The next polling round gets simulated again and observes the updated flag.
+}
+
+
+
+// The last polling round did not overlap with any other transaction, so it shows the undisturbed timing:
+// The read takes readtime and samples the flag after sampleoffset, the round takes period.
+// As long as no other transaction begins, the following rounds repeat this timing and do not influence anybody.
+// Every change of the flag is a transaction as well. So the tile sleeps until the next transaction begins,
+// and then continues where the skipped rounds would be:
+//  - Between two reads:  The next round gets simulated as usual.
+//  - During the memory access of a read: The rest of the read gets replayed on the interconnect,
+//    so the new transaction and the replayed read see each other in their penalties.
+//  - During the penalty of a read: The tile stays contender until the read would end.
+// A transaction beginning at the same time a skipped read samples the flag counts as beginning afterwards.
+// Returns true if a replayed read needs its round to be finished. usage is the flag value it read then.
+bool Channel::FastForwardSharedPolling(Tile *tile, Interconnect *interconnect, sc_core::sc_time period, sc_core::sc_time readtime, sc_core::sc_time sampleoffset, unsigned int &usage)
+{
+    tile->Synchronize();
+    if(not interconnect->AllowsPollingFastForward())
+        return false;
+
+    sc_core::sc_time roundstart = sc_core::sc_time_stamp();
+    interconnect->SleepWhilePolling(this->usageevent);
+
+    sc_dt::uint64 elapsed = (sc_core::sc_time_stamp() - roundstart).value();
+    sc_dt::uint64 rounds  = elapsed / period.value();
+    sc_core::sc_time phase   = sc_core::sc_time::from_value(elapsed % period.value());
+    sc_core::sc_time current = roundstart + sc_core::sc_time::from_value(rounds * period.value());
+    interconnect->EndPolling(rounds);
+
+    if(phase == sc_core::SC_ZERO_TIME)
+        return false;
+
+    if(phase < sampleoffset)
     {
-        unsigned long long address;
-        address  = this->fifoaddress;
-        address += index;
-        sc_core::wait(2, sc_core::SC_NS);
-        this->producertile->WriteWord(address, reinterpret_cast< unsigned int* >(&tokens[tokenindex]));
-        index   += 1;
-        sc_core::wait(5, sc_core::SC_NS);
+        interconnect->BeginPolledRead();
+        sc_core::wait(sampleoffset - phase);
+        usage                 = static_cast<unsigned int>(this->usagevalue);
+        this->usagesampletime = sc_core::sc_time_stamp();
+        interconnect->EndPolledRead(true);
+        return true;
     }
-    
-    // Management Block
-    this->TracePhase("W:manag.");
-    usage = 1;
-    this->producertile->WriteWord(this->usageaddress, &usage);
-    sc_core::wait(3, sc_core::SC_NS);
 
-    this->TracePhase("idle");
+    if(phase < readtime)
+    {
+        interconnect->BeginPolledRead();
+        sc_core::wait(readtime - phase);
+        interconnect->EndPolledRead(false);
+        return true;    // usage still holds the value of the last simulated round
+    }
+
+    // The skipped round already decided to poll again
+    sc_core::wait(current + period - sc_core::sc_time_stamp());
+    return false;
 }
 
 
@@ -206,45 +362,39 @@ void Channel::WriteTokensCycleAccurate(token_t tokens[])
 void Channel::ReadTokensEventBased(token_t tokens[])
 {
     // Initialization Block
-    this->TracePhase("R:init.");
+    this->TracePhase(TRACEPHASE::CHANNEL_READINIT);
     unsigned int usage;
-    sc_core::wait(1, sc_core::SC_NS);
+    this->consumertile->Wait(sc_core::sc_time(1, sc_core::SC_NS));
 
     // Polling Block
-    this->TracePhase("R:polling");
+    this->TracePhase(TRACEPHASE::CHANNEL_READPOLLING);
     this->consumertile->ReadWord(this->usageaddress, &usage);
+    this->consumertile->Synchronize();
     if(usage == 0)
         sc_core::wait(this->fullevent);
 
     // Preparation Block
-    this->TracePhase("R:prep.");
-    unsigned int index;
-    index = 0;
-    sc_core::wait(5, sc_core::SC_NS);
+    this->TracePhase(TRACEPHASE::CHANNEL_READPREPARE);
+    this->consumertile->Wait(sc_core::sc_time(5, sc_core::SC_NS));
 
     // Copy Block
-    this->TracePhase("R:copying");
-    for(unsigned int tokenindex = 0; tokenindex < this->consumerate; tokenindex++)
-    {
-        unsigned long long address;
-        address  = this->fifoaddress;
-        address += index;
-        this->consumertile->ReadWord(address, reinterpret_cast< unsigned int* >(&tokens[tokenindex]));
-        index   += 1;
-
-        sc_core::wait(5, sc_core::SC_NS);
-        if(tokenindex+1 < this->consumerate)
-            sc_core::wait(2, sc_core::SC_NS);
-    }
-    sc_core::wait(1, sc_core::SC_NS);
+    // Each token read is followed by 5 cycles, plus 2 cycles between two tokens
+    this->TracePhase(TRACEPHASE::CHANNEL_READCOPYING);
+    this->consumertile->ReadBurst(this->fifoaddress,
+            reinterpret_cast< unsigned int* >(tokens),
+            this->consumerate,
+            sc_core::sc_time(5 + 2, sc_core::SC_NS));
+    this->consumertile->Wait(sc_core::sc_time(5, sc_core::SC_NS));
+    this->consumertile->Wait(sc_core::sc_time(1, sc_core::SC_NS));
 
     // Update meta data
-    this->TracePhase("R:manag.");
+    this->TracePhase(TRACEPHASE::CHANNEL_READMANAGE);
     usage = 0;
     this->consumertile->WriteWord(this->usageaddress, &usage);
+    this->consumertile->Synchronize();
     this->emptyevent.notify();
-    sc_core::wait(3, sc_core::SC_NS);
-    this->TracePhase("idle");
+    this->consumertile->Wait(sc_core::sc_time(3, sc_core::SC_NS));
+    this->TracePhase(TRACEPHASE::CHANNEL_IDLE);
 }
 
 
@@ -252,42 +402,39 @@ void Channel::ReadTokensEventBased(token_t tokens[])
 void Channel::WriteTokensEventBased(token_t tokens[])
 {
     // Initialization Block
-    this->TracePhase("W:init.");
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEINIT);
     unsigned int usage;
-    sc_core::wait(1, sc_core::SC_NS);
+    this->producertile->Wait(sc_core::sc_time(1, sc_core::SC_NS));
 
     // Polling Block
-    this->TracePhase("W:polling");
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEPOLLING);
     this->producertile->ReadWord(this->usageaddress, &usage);
+    this->producertile->Synchronize();
     if(usage != 0)
         sc_core::wait(this->emptyevent);
 
     // Preparation Block
-    this->TracePhase("W:prep.");
-    unsigned int index;
-    index = 0;
-    sc_core::wait(4, sc_core::SC_NS);
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEPREPARE);
+    this->producertile->Wait(sc_core::sc_time(4, sc_core::SC_NS));
 
     // Copy Block
-    this->TracePhase("W:copying");
-    for(unsigned int tokenindex = 0; tokenindex < this->producerate; tokenindex++)
-    {
-        unsigned long long address;
-        address  = this->fifoaddress;
-        address += index;
-        sc_core::wait(2, sc_core::SC_NS);
-        this->producertile->WriteWord(address, reinterpret_cast< unsigned int* >(&tokens[tokenindex]));
-        index   += 1;
-        sc_core::wait(5, sc_core::SC_NS);
-    }
+    // Each token write is preceded by 2 cycles and followed by 5 cycles
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITECOPYING);
+    this->producertile->Wait(sc_core::sc_time(2, sc_core::SC_NS));
+    this->producertile->WriteBurst(this->fifoaddress,
+            reinterpret_cast< unsigned int* >(tokens),
+            this->producerate,
+            sc_core::sc_time(5 + 2, sc_core::SC_NS));
+    this->producertile->Wait(sc_core::sc_time(5, sc_core::SC_NS));
     
     // Management Block
-    this->TracePhase("W:manag.");
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEMANAGE);
     usage = 1;
     this->producertile->WriteWord(this->usageaddress, &usage);
+    this->producertile->Synchronize();
     this->fullevent.notify();
-    sc_core::wait(3, sc_core::SC_NS);
-    this->TracePhase("idle");
+    this->producertile->Wait(sc_core::sc_time(3, sc_core::SC_NS));
+    this->TracePhase(TRACEPHASE::CHANNEL_IDLE);
 }
 
 
@@ -336,13 +483,14 @@ void Channel::ReadTokensMessageLevel(token_t tokens[])
     */
 
     //Initialization
-    this->TracePhase("R:init.");
-    sc_core::wait(ElementaryDelays.t_init_r, sc_core::SC_NS); 
+    this->TracePhase(TRACEPHASE::CHANNEL_READINIT);
+    this->consumertile->Wait(sc_core::sc_time(ElementaryDelays.t_init_r, sc_core::SC_NS)); 
 
     //Polling
-    this->TracePhase("R:polling");
+    this->TracePhase(TRACEPHASE::CHANNEL_READPOLLING);
     unsigned int usage;
     this->consumertile->ReadWord(this->usageaddress, &usage);
+    this->consumertile->Synchronize();
     if(usage == 0)
     {
         NumPollingActors++;
@@ -351,11 +499,11 @@ void Channel::ReadTokensMessageLevel(token_t tokens[])
     }
 
     //Preparation
-    this->TracePhase("R:prep.");
-    sc_core::wait(ElementaryDelays.t_pr_r, sc_core::SC_NS); 
+    this->TracePhase(TRACEPHASE::CHANNEL_READPREPARE);
+    this->consumertile->Wait(sc_core::sc_time(ElementaryDelays.t_pr_r, sc_core::SC_NS)); 
 
     //Copy data
-    this->TracePhase("R:copying");
+    this->TracePhase(TRACEPHASE::CHANNEL_READCOPYING);
     NumReadingActors++;
 
     int delayOffset;
@@ -365,25 +513,20 @@ void Channel::ReadTokensMessageLevel(token_t tokens[])
             this->consumerate,
             delayOffset,
             ElementaryDelays.t_w_loop);
-    sc_core::wait(copydelay, sc_core::SC_NS);
+    this->consumertile->Wait(sc_core::sc_time(copydelay, sc_core::SC_NS));
 
-    unsigned int index = 0;
-    for(unsigned int tokenindex = 0; tokenindex < this->consumerate; tokenindex++)
-    {
-        unsigned long long address;
-        address  = this->fifoaddress;
-        address += index;
-        this->consumertile->ReadWord(address, reinterpret_cast< unsigned int* >(&tokens[tokenindex]));
-        index   += 1;
-    }
+    this->consumertile->ReadBurst(this->fifoaddress,
+            reinterpret_cast< unsigned int* >(tokens),
+            this->consumerate);
 
-    this->TracePhase("R:manag.");
+    this->TracePhase(TRACEPHASE::CHANNEL_READMANAGE);
     usage = 0;
     this->consumertile->WriteWord(this->usageaddress, &usage);
+    this->consumertile->Synchronize();
     this->emptyevent.notify();
     NumReadingActors--;
 
-    this->TracePhase("R:idle");
+    this->TracePhase(TRACEPHASE::CHANNEL_READIDLE);
     return;
 }
 
@@ -400,13 +543,14 @@ void Channel::WriteTokensMessageLevel(token_t tokens[])
     */
 
     //Initialization
-    this->TracePhase("W:init.");
-    sc_core::wait(ElementaryDelays.t_init_w, sc_core::SC_NS);      
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEINIT);
+    this->producertile->Wait(sc_core::sc_time(ElementaryDelays.t_init_w, sc_core::SC_NS));      
 
     //Polling
-    this->TracePhase("W:polling");
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEPOLLING);
     unsigned int usage;
     this->producertile->ReadWord(this->usageaddress, &usage);
+    this->producertile->Synchronize();
     if(usage != 0)
     {
         NumPollingActors++;
@@ -415,11 +559,11 @@ void Channel::WriteTokensMessageLevel(token_t tokens[])
     }
 
     //Preparation
-    this->TracePhase("W:prep.");
-    sc_core::wait(ElementaryDelays.t_pr_w, sc_core::SC_NS); 
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEPREPARE);
+    this->producertile->Wait(sc_core::sc_time(ElementaryDelays.t_pr_w, sc_core::SC_NS)); 
 
     //Copy data
-    this->TracePhase("W:copying");
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITECOPYING);
     NumWritingActors++;
 
     int delayOffset;
@@ -429,25 +573,20 @@ void Channel::WriteTokensMessageLevel(token_t tokens[])
             this->producerate,
             delayOffset,
             ElementaryDelays.t_w_loop);
-    sc_core::wait(copydelay, sc_core::SC_NS);
+    this->producertile->Wait(sc_core::sc_time(copydelay, sc_core::SC_NS));
 
-    unsigned int index = 0;
-    for(unsigned int tokenindex = 0; tokenindex < this->producerate; tokenindex++)
-    {
-        unsigned long long address;
-        address  = this->fifoaddress;
-        address += index;
-        this->producertile->WriteWord(address, reinterpret_cast< unsigned int* >(&tokens[tokenindex]));
-        index   += 1;
-    }
+    this->producertile->WriteBurst(this->fifoaddress,
+            reinterpret_cast< unsigned int* >(tokens),
+            this->producerate);
 
-    this->TracePhase("W:manag.");
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEMANAGE);
     usage = 1;
     this->producertile->WriteWord(this->usageaddress, &usage);
+    this->producertile->Synchronize();
     this->fullevent.notify();
     NumWritingActors--;
 
-    this->TracePhase("W:idle");
+    this->TracePhase(TRACEPHASE::CHANNEL_WRITEIDLE);
     return;
 }
 
@@ -3,6 +3,8 @@
 
 #include <systemc>
 #include <string>
+#include <istream>
+#include <ostream>
 
 #include <monitor.hpp>
 #include <hardware/interconnect.hpp>
@@ -36,8 +38,29 @@ class Channel
         void ReadTokens(token_t tokens[]);
         void WriteTokens(token_t tokens[]);
 
+        // Polling fast-forward for the cycle accurate model.
+        // Instead of simulating each polling round, the polling tile sleeps while its rounds
+        // would not interact with other transactions, and continues with the round
+        // that would be in progress then. Meant to keep the iteration durations,
+        // which is not verified against runs without fast-forward yet (see README).
+        void EnablePollingFastForward(bool enable=true);
+
+        // Called by the memory the channel is mapped to
+        // whenever the usage flag gets sampled or updated.
+        void UsageSampled(sc_core::sc_time time);
+        void UsageUpdated(unsigned long usage, sc_core::sc_time time);
+
+        // What the channel remembers about its usage flag, for checkpoints.
+        // The tokens and the flag itself are part of the memory the channel is mapped to.
+        void SaveState(std::ostream &state) const;
+        void LoadState(std::istream &state);
+
     private:
-        void TracePhase(const char* phase);
+        void TracePhase(TRACEPHASE phase);
+
+        void PollCycleAccurate(Tile *tile, bool waitforfull);
+        void FastForwardPrivatePolling(Tile *tile, bool waitforfull, sc_core::sc_time roundstart, sc_core::sc_time period, sc_core::sc_time sampleoffset);
+        bool FastForwardSharedPolling(Tile *tile, Interconnect *interconnect, sc_core::sc_time period, sc_core::sc_time readtime, sc_core::sc_time sampleoffset, unsigned int &usage);
 
         void ReadTokensCycleAccurate(token_t tokens[]);
         void WriteTokensCycleAccurate(token_t tokens[]);
@@ -56,8 +79,15 @@ class Channel
         sc_core::sc_event fullevent;
 
         Monitor *monitor;   // Can be NULL!
+        TraceSignal tracesignal;
 
         COMMUNICATIONMODEL model;
+
+        bool              pollingfastforward;
+        unsigned long     usagevalue;       // Last value written to the usage flag
+        sc_core::sc_time  usageupdatetime;  // Time stamp of the last usage flag update
+        sc_core::sc_time  usagesampletime;  // Time stamp of the last usage flag read access
+        sc_core::sc_event usageevent;       // Notified on each usage flag update
 };
 
 
@@ -0,0 +1,84 @@
+#ifndef STATESTREAM_HPP
+#define STATESTREAM_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Raw binary serialization of the simulation state for checkpoints (see checkpoint.hpp).
+// The values get stored in the byte order of the host,
+// so a checkpoint can only be resumed by the same build on the same kind of machine.
+// Reading past the end of the state throws a std::runtime_error.
+
+namespace state
+{
+
+template<typename T>
+inline void Write(std::ostream &stream, const T &value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written directly");
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+inline T Read(std::istream &stream)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be read directly");
+    T value;
+    if(not stream.read(reinterpret_cast<char*>(&value), sizeof(T)))
+        throw std::runtime_error("Checkpoint is truncated");
+    return value;
+}
+
+
+
+inline void WriteString(std::ostream &stream, const std::string &value)
+{
+    Write<uint64_t>(stream, value.size());
+    stream.write(value.data(), value.size());
+}
+
+inline std::string ReadString(std::istream &stream)
+{
+    std::string value(Read<uint64_t>(stream), '\0');
+    if(not stream.read(&value[0], value.size()))
+        throw std::runtime_error("Checkpoint is truncated");
+    return value;
+}
+
+// Components write their name in front of their state.
+// Reading it back detects checkpoints of a different experiment or build.
+inline void ExpectString(std::istream &stream, const std::string &expected)
+{
+    std::string value = ReadString(stream);
+    if(value != expected)
+        throw std::runtime_error("Checkpoint does not match the simulation (found " + value + " instead of " + expected + ")");
+}
+
+
+
+template<typename T>
+inline void WriteVector(std::ostream &stream, const std::vector<T> &values)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only vectors of plain values can be written directly");
+    Write<uint64_t>(stream, values.size());
+    stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+template<typename T>
+inline void ReadVector(std::istream &stream, std::vector<T> &values)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only vectors of plain values can be read directly");
+    values.resize(Read<uint64_t>(stream));
+    if(not stream.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(T)))
+        throw std::runtime_error("Checkpoint is truncated");
+}
+
+} // namespace
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,399 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <statistics.hpp>
+#include <statestream.hpp>
+
+// P² Quantile ///////////////
+
+
+P2Quantile::P2Quantile(double p)
+    : p(p)
+    , count(0)
+    , q()
+    , n( {0, 1, 2, 3, 4})
+    , np({0, 2*p, 4*p, 2+2*p, 4})
+    , dn({0, p/2, p, (1+p)/2, 1})
+{
+}
+
+
+
+void P2Quantile::Add(double x)
+{
+    // The first five samples initialize the markers
+    if(this->count < 5)
+    {
+        this->q[this->count++] = x;
+        if(this->count == 5)
+            std::sort(this->q.begin(), this->q.end());
+        return;
+    }
+    this->count++;
+
+    // Find the cell k the sample falls into and adjust the extreme markers
+    int k;
+    if(x < this->q[0])
+    {
+        this->q[0] = x;
+        k = 0;
+    }
+    else if(x >= this->q[4])
+    {
+        this->q[4] = x;
+        k = 3;
+    }
+    else
+    {
+        k = 0;
+        while(x >= this->q[k+1])
+            k++;
+    }
+
+    for(int i = k+1; i < 5; i++)
+        this->n[i] += 1;
+    for(int i = 0; i < 5; i++)
+        this->np[i] += this->dn[i];
+
+    // Move the middle markers towards their desired positions
+    for(int i = 1; i < 4; i++)
+    {
+        double d = this->np[i] - this->n[i];
+        if((d >=  1 and this->n[i+1] - this->n[i] >  1)
+        or (d <= -1 and this->n[i-1] - this->n[i] < -1))
+        {
+            int    sign   = (d < 0) ? -1 : 1;
+            double height = this->Parabolic(i, sign);
+            if(this->q[i-1] < height and height < this->q[i+1])
+                this->q[i] = height;
+            else
+                this->q[i] = this->Linear(i, sign);
+            this->n[i] += sign;
+        }
+    }
+}
+
+
+
+double P2Quantile::Parabolic(int i, double d) const
+{
+    return this->q[i] + d / (this->n[i+1] - this->n[i-1])
+        * ( (this->n[i] - this->n[i-1] + d) * (this->q[i+1] - this->q[i]) / (this->n[i+1] - this->n[i])
+          + (this->n[i+1] - this->n[i] - d) * (this->q[i] - this->q[i-1]) / (this->n[i] - this->n[i-1]));
+}
+
+double P2Quantile::Linear(int i, int d) const
+{
+    return this->q[i] + d * (this->q[i+d] - this->q[i]) / (this->n[i+d] - this->n[i]);
+}
+
+
+
+double P2Quantile::Get() const
+{
+    if(this->count == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    // With less than five samples, the quantile can be taken directly
+    if(this->count < 5)
+    {
+        std::array<double, 5> sorted = this->q;
+        std::sort(sorted.begin(), sorted.begin() + this->count);
+        return sorted[static_cast<size_t>(std::round(this->p * (this->count - 1)))];
+    }
+
+    return this->q[2];
+}
+
+
+
+void P2Quantile::SaveState(std::ostream &state) const
+{
+    state::Write(state, this->p);
+    state::Write(state, this->count);
+    state::Write(state, this->q);
+    state::Write(state, this->n);
+    state::Write(state, this->np);
+}
+
+// The increments only depend on p
+void P2Quantile::LoadState(std::istream &state)
+{
+    if(state::Read<double>(state) != this->p)
+        throw std::runtime_error("Checkpoint does not match the quantiles of the statistics");
+    this->count = state::Read<uint64_t>(state);
+    this->q     = state::Read<std::array<double, 5>>(state);
+    this->n     = state::Read<std::array<double, 5>>(state);
+    this->np    = state::Read<std::array<double, 5>>(state);
+}
+
+
+
+// Histogram ///////////////
+
+
+Histogram::Histogram(unsigned int bins, unsigned int rangesamples)
+    : bins(bins, 0)
+    , rangesamples(rangesamples)
+    , ranged(false)
+    , lower(0.0)
+    , width(0.0)
+    , underflow(0)
+    , overflow(0)
+{
+    this->pending.reserve(rangesamples);
+}
+
+
+
+void Histogram::Add(double x)
+{
+    if(this->ranged)
+    {
+        this->Insert(x);
+        return;
+    }
+
+    this->pending.push_back(x);
+    if(this->pending.size() >= this->rangesamples)
+        this->Finalize();
+}
+
+
+
+void Histogram::Finalize()
+{
+    if(this->ranged or this->pending.empty())
+        return;
+
+    // The range covers the first samples plus a margin of 25% on each side
+    auto   extremes = std::minmax_element(this->pending.begin(), this->pending.end());
+    double minimum  = *extremes.first;
+    double maximum  = *extremes.second;
+    double margin   = (maximum - minimum) * 0.25;
+    if(margin == 0.0)
+        margin = 1.0;
+
+    // The iteration durations are whole nanoseconds. With an integer lower bound and bin width,
+    // each bin covers the same number of possible values, so the histogram shows no sawtooth pattern.
+    this->lower  = std::floor(std::max(0.0, minimum - margin));
+    this->width  = std::max(1.0, std::ceil((maximum + margin - this->lower) / this->bins.size()));
+    this->ranged = true;
+
+    for(double x : this->pending)
+        this->Insert(x);
+    this->pending.clear();
+    this->pending.shrink_to_fit();
+}
+
+
+
+void Histogram::Insert(double x)
+{
+    if(x < this->lower)
+    {
+        this->underflow++;
+        return;
+    }
+
+    size_t bin = static_cast<size_t>((x - this->lower) / this->width);
+    if(bin >= this->bins.size())
+        this->overflow++;
+    else
+        this->bins[bin]++;
+}
+
+
+
+void Histogram::SaveState(std::ostream &state) const
+{
+    state::WriteVector(state, this->bins);
+    state::WriteVector(state, this->pending);
+    state::Write(state, this->ranged);
+    state::Write(state, this->lower);
+    state::Write(state, this->width);
+    state::Write(state, this->underflow);
+    state::Write(state, this->overflow);
+}
+
+void Histogram::LoadState(std::istream &state)
+{
+    state::ReadVector(state, this->bins);
+    state::ReadVector(state, this->pending);
+    this->ranged    = state::Read<bool>(state);
+    this->lower     = state::Read<double>(state);
+    this->width     = state::Read<double>(state);
+    this->underflow = state::Read<uint64_t>(state);
+    this->overflow  = state::Read<uint64_t>(state);
+}
+
+
+
+// Online Statistics ///////////////
+
+
+OnlineStatistics::OnlineStatistics()
+    : count(0)
+    , minimum(std::numeric_limits<uint64_t>::max())
+    , maximum(0)
+    , mean(0.0)
+    , m2(0.0)
+    , quantiles({0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99})
+    , histogram()
+{
+}
+
+
+
+void OnlineStatistics::Add(uint64_t sample)
+{
+    double x = static_cast<double>(sample);
+
+    this->count++;
+    double delta = x - this->mean;
+    this->mean  += delta / this->count;
+    this->m2    += delta * (x - this->mean);
+
+    this->minimum = std::min(this->minimum, sample);
+    this->maximum = std::max(this->maximum, sample);
+
+    for(auto &quantile : this->quantiles)
+        quantile.Add(x);
+
+    this->histogram.Add(x);
+}
+
+
+
+double OnlineStatistics::GetVariance() const
+{
+    if(this->count < 2)
+        return 0.0;
+    return this->m2 / (this->count - 1);
+}
+
+double OnlineStatistics::GetStandardDeviation() const
+{
+    return std::sqrt(this->GetVariance());
+}
+
+double OnlineStatistics::GetStandardError() const
+{
+    if(this->count == 0)
+        return 0.0;
+    return this->GetStandardDeviation() / std::sqrt(static_cast<double>(this->count));
+}
+
+
+
+void OnlineStatistics::SaveState(std::ostream &state) const
+{
+    state::Write(state, this->count);
+    state::Write(state, this->minimum);
+    state::Write(state, this->maximum);
+    state::Write(state, this->mean);
+    state::Write(state, this->m2);
+
+    state::Write<uint64_t>(state, this->quantiles.size());
+    for(const P2Quantile &quantile : this->quantiles)
+        quantile.SaveState(state);
+    this->histogram.SaveState(state);
+}
+
+void OnlineStatistics::LoadState(std::istream &state)
+{
+    this->count   = state::Read<uint64_t>(state);
+    this->minimum = state::Read<uint64_t>(state);
+    this->maximum = state::Read<uint64_t>(state);
+    this->mean    = state::Read<double>(state);
+    this->m2      = state::Read<double>(state);
+
+    if(state::Read<uint64_t>(state) != this->quantiles.size())
+        throw std::runtime_error("Checkpoint does not match the quantiles of the statistics");
+    for(P2Quantile &quantile : this->quantiles)
+        quantile.LoadState(state);
+    this->histogram.LoadState(state);
+}
+
+
+
+// Quotes, backslashes and control characters must be escaped inside a JSON string
+static std::string JSONString(const std::string &string)
+{
+    std::ostringstream escaped;
+    escaped << '"';
+    for(char c : string)
+    {
+        switch(c)
+        {
+            case '"':  escaped << "\\\""; break;
+            case '\\': escaped << "\\\\"; break;
+            case '\n': escaped << "\\n";  break;
+            case '\r': escaped << "\\r";  break;
+            case '\t': escaped << "\\t";  break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20)
+                    escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+                else
+                    escaped << c;
+        }
+    }
+    escaped << '"';
+    return escaped.str();
+}
+
+
+
+// The summary gets built in its own stream, so the formatting of the given stream (usually std::cerr) stays untouched
+void OnlineStatistics::WriteSummary(std::ostream &output, const std::string &experimentname, bool interrupted)
+{
+    this->histogram.Finalize();
+
+    std::ostringstream stream;
+    stream << std::setprecision(10);
+    stream << "{\n";
+    stream << "  \"experiment\": " << JSONString(experimentname) << ",\n";
+    stream << "  \"unit\": \"ns\",\n";
+    stream << "  \"samples\": " << this->count << ",\n";
+    if(interrupted)
+        stream << "  \"interrupted\": true,\n";   // samples covers the completed iterations only
+    if(this->count > 0)
+    {
+        stream << "  \"min\": "    << this->minimum << ",\n";
+        stream << "  \"max\": "    << this->maximum << ",\n";
+        stream << "  \"mean\": "   << this->mean << ",\n";
+        stream << "  \"stddev\": " << this->GetStandardDeviation() << ",\n";
+        stream << "  \"stderr\": " << this->GetStandardError() << ",\n";
+        stream << "  \"quantiles\": {";
+        for(size_t i = 0; i < this->quantiles.size(); i++)
+        {
+            stream << (i > 0 ? ", " : " ")
+                   << "\"" << this->quantiles[i].GetProbability() << "\": "
+                   << this->quantiles[i].Get();
+        }
+        stream << " },\n";
+        stream << "  \"histogram\": {\n";
+        stream << "    \"lower\": "     << this->histogram.GetLowerBound() << ",\n";
+        stream << "    \"binwidth\": "  << this->histogram.GetBinWidth()   << ",\n";
+        stream << "    \"underflow\": " << this->histogram.GetUnderflow()  << ",\n";
+        stream << "    \"overflow\": "  << this->histogram.GetOverflow()   << ",\n";
+        stream << "    \"bins\": [";
+        const std::vector<uint64_t> &bins = this->histogram.GetBins();
+        for(size_t i = 0; i < bins.size(); i++)
+            stream << (i > 0 ? ", " : "") << bins[i];
+        stream << "]\n";
+        stream << "  }\n";
+    }
+    else
+    {
+        stream << "  \"note\": \"no iteration durations were recorded\"\n";
+    }
+    stream << "}\n";
+
+    output << stream.str();
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
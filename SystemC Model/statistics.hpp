@@ -0,0 +1,116 @@
+#ifndef STATISTICS_HPP
+#define STATISTICS_HPP
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Streaming quantile estimation with the P² algorithm
+// (Jain, Chlamtac: The P² Algorithm for Dynamic Calculation of Quantiles and Histograms Without Storing Observations, 1985)
+// Only five markers are stored, independent of the number of samples.
+
+class P2Quantile
+{
+    public:
+        P2Quantile(double p);
+
+        void   Add(double x);
+        double Get() const;
+        double GetProbability() const { return this->p; };
+
+        void SaveState(std::ostream &state) const;
+        void LoadState(std::istream &state);
+
+    private:
+        double Parabolic(int i, double d) const;
+        double Linear(int i, int d) const;
+
+        double   p;
+        uint64_t count;
+        std::array<double, 5> q;    // marker heights
+        std::array<double, 5> n;    // marker positions
+        std::array<double, 5> np;   // desired marker positions
+        std::array<double, 5> dn;   // increments of the desired positions
+};
+
+
+
+// Histogram with a fixed number of equally sized bins.
+// The range gets derived from the first samples, which are buffered until then.
+// The lower bound and the bin width are whole numbers, like the samples.
+// Later samples outside the range are counted as underflow or overflow.
+
+class Histogram
+{
+    public:
+        Histogram(unsigned int bins = 100, unsigned int rangesamples = 1000);
+
+        void Add(double x);
+        void Finalize();    // Fixes the range even if less samples than rangesamples were added
+
+        double   GetLowerBound() const { return this->lower; };
+        double   GetBinWidth()   const { return this->width; };
+        uint64_t GetUnderflow()  const { return this->underflow; };
+        uint64_t GetOverflow()   const { return this->overflow; };
+        const std::vector<uint64_t>& GetBins() const { return this->bins; };
+
+        void SaveState(std::ostream &state) const;
+        void LoadState(std::istream &state);
+
+    private:
+        void Insert(double x);
+
+        std::vector<uint64_t> bins;
+        std::vector<double>   pending;  // Samples collected before the range is known
+        unsigned int          rangesamples;
+        bool                  ranged;
+        double                lower;
+        double                width;
+        uint64_t              underflow;
+        uint64_t              overflow;
+};
+
+
+
+// Statistics of the iteration durations, updated with each sample:
+// Mean and variance (Welford), minimum, maximum, quantiles and a histogram.
+
+class OnlineStatistics
+{
+    public:
+        OnlineStatistics();
+
+        void Add(uint64_t sample);
+
+        uint64_t GetCount()    const { return this->count; };
+        uint64_t GetMinimum()  const { return this->minimum; };
+        uint64_t GetMaximum()  const { return this->maximum; };
+        double   GetMean()     const { return this->mean; };
+        double   GetVariance() const;   // sample variance
+        double   GetStandardDeviation() const;
+        double   GetStandardError()     const;  // of the mean
+        const std::vector<P2Quantile>& GetQuantiles() const { return this->quantiles; };
+
+        // Writes all statistics as JSON object. An interrupted simulation gets marked as such.
+        void WriteSummary(std::ostream &stream, const std::string &experimentname, bool interrupted = false);
+
+        // All accumulated values for checkpoints, so the summary continues seamlessly after a restore
+        void SaveState(std::ostream &state) const;
+        void LoadState(std::istream &state);
+
+    private:
+        uint64_t count;
+        uint64_t minimum;
+        uint64_t maximum;
+        double   mean;
+        double   m2;        // Sum of squared differences from the mean
+
+        std::vector<P2Quantile> quantiles;
+        Histogram               histogram;
+};
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
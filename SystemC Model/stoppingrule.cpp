@@ -0,0 +1,241 @@
+#include <stoppingrule.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <gsl/gsl_cdf.h>
+#include <statestream.hpp>
+
+StoppingRule::StoppingRule(double precision, const std::vector<double> &quantiles, double confidence)
+    : precision(precision)
+    , quantiles(quantiles)
+    , confidence(confidence)
+    , nextcheck(StoppingRule::MINIMUMSAMPLES)
+    , reached(false)
+    , truncation(0)
+    , batchsize(0)
+{
+}
+
+
+
+bool StoppingRule::Add(uint64_t sample)
+{
+    this->samples.push_back(static_cast<double>(sample));
+    if(this->samples.size() < this->nextcheck or this->reached)
+        return this->reached;
+
+    this->nextcheck = this->samples.size() + std::max<uint64_t>(this->samples.size() / 10, StoppingRule::MINIMUMSAMPLES);
+    this->reached   = this->Check();
+    return this->reached;
+}
+
+
+
+void StoppingRule::Finish()
+{
+    if(not this->reached)
+        this->reached = this->Check();
+}
+
+bool StoppingRule::IsReached() const
+{
+    return this->reached;
+}
+
+
+
+void StoppingRule::SaveState(std::ostream &state) const
+{
+    state::Write(state, this->precision);
+    state::WriteVector(state, this->samples);
+    state::Write(state, this->nextcheck);
+    state::Write(state, this->reached);
+
+    state::Write<uint64_t>(state, this->truncation);
+    state::Write<uint64_t>(state, this->batchsize);
+    state::Write<uint64_t>(state, this->estimates.size());
+    for(const Estimate &estimate : this->estimates)
+    {
+        state::WriteString(state, estimate.name);
+        state::Write(state, estimate.value);
+        state::Write(state, estimate.halfwidth);
+    }
+}
+
+void StoppingRule::LoadState(std::istream &state)
+{
+    if(state::Read<double>(state) != this->precision)
+        throw std::runtime_error("Checkpoint does not match the target precision");
+    state::ReadVector(state, this->samples);
+    this->nextcheck = state::Read<uint64_t>(state);
+    this->reached   = state::Read<bool>(state);
+
+    this->truncation = state::Read<uint64_t>(state);
+    this->batchsize  = state::Read<uint64_t>(state);
+    this->estimates.resize(state::Read<uint64_t>(state));
+    for(Estimate &estimate : this->estimates)
+    {
+        estimate.name      = state::ReadString(state);
+        estimate.value     = state::Read<double>(state);
+        estimate.halfwidth = state::Read<double>(state);
+    }
+}
+
+
+
+// Minimizes the MSER statistic over the truncation point d (in batches of 5):
+//   MSER(d) = sum_{j>=d} (z_j - mean_d)^2 / (m - d)^2
+// The suffix sums get accumulated from the end, so all truncation points are evaluated in one pass.
+size_t StoppingRule::Truncation() const
+{
+    size_t m = this->samples.size() / StoppingRule::MSERBATCHSIZE;
+    if(m < 2)
+        return SIZE_MAX;
+
+    std::vector<double> z(m);
+    for(size_t j = 0; j < m; j++)
+    {
+        double sum = 0.0;
+        for(size_t i = 0; i < StoppingRule::MSERBATCHSIZE; i++)
+            sum += this->samples[j * StoppingRule::MSERBATCHSIZE + i];
+        z[j] = sum / StoppingRule::MSERBATCHSIZE;
+    }
+
+    // Shifting the values avoids cancellation in the sum of squares
+    double shift = z[m - 1];
+    double sum   = 0.0;
+    double sumsq = 0.0;
+    double best  = std::numeric_limits<double>::infinity();
+    size_t bestd = 0;
+    for(size_t d = m; d-- > 0; )
+    {
+        double value = z[d] - shift;
+        sum   += value;
+        sumsq += value * value;
+        if(d > m / 2)
+            continue;
+
+        double count = m - d;
+        double mser  = std::max(sumsq - sum * sum / count, 0.0) / (count * count);
+        if(mser <= best)
+        {
+            best  = mser;
+            bestd = d;
+        }
+    }
+
+    if(bestd == m / 2)
+        return SIZE_MAX;
+    return bestd * StoppingRule::MSERBATCHSIZE;
+}
+
+
+
+double StoppingRule::BatchQuantile(size_t first, size_t size, double p)
+{
+    this->scratch.assign(this->samples.begin() + first, this->samples.begin() + first + size);
+    size_t rank = std::min(static_cast<size_t>(p * size), size - 1);
+    std::nth_element(this->scratch.begin(), this->scratch.begin() + rank, this->scratch.end());
+    return this->scratch[rank];
+}
+
+
+
+bool StoppingRule::Check()
+{
+    this->estimates.clear();
+
+    this->truncation = this->Truncation();
+    if(this->truncation == SIZE_MAX)
+        return false;
+
+    this->batchsize = (this->samples.size() - this->truncation) / StoppingRule::BATCHES;
+    if(this->batchsize < 2)
+        return false;
+
+    // Durations that do not fill a batch get dropped at the beginning
+    size_t first = this->samples.size() - this->batchsize * StoppingRule::BATCHES;
+    double t     = gsl_cdf_tdist_Pinv(0.5 + this->confidence / 2.0, StoppingRule::BATCHES - 1);
+
+    std::vector<double> probabilities = this->quantiles;
+    if(probabilities.empty())
+        probabilities.push_back(-1.0);  // mean
+
+    bool reached = true;
+    std::vector<double> values(StoppingRule::BATCHES);
+    for(double p : probabilities)
+    {
+        for(size_t batch = 0; batch < StoppingRule::BATCHES; batch++)
+        {
+            size_t begin = first + batch * this->batchsize;
+            if(p < 0.0)
+            {
+                double sum = 0.0;
+                for(size_t i = begin; i < begin + this->batchsize; i++)
+                    sum += this->samples[i];
+                values[batch] = sum / this->batchsize;
+            }
+            else
+                values[batch] = this->BatchQuantile(begin, this->batchsize, p);
+        }
+
+        double mean = 0.0;
+        for(double value : values)
+            mean += value;
+        mean /= values.size();
+        double variance = 0.0;
+        for(double value : values)
+            variance += (value - mean) * (value - mean);
+        variance /= values.size() - 1;
+
+        Estimate estimate;
+        std::ostringstream name;
+        if(p < 0.0)
+            name << "mean";
+        else
+            name << "p" << p * 100.0;
+        estimate.name      = name.str();
+        estimate.value     = mean;
+        estimate.halfwidth = t * std::sqrt(variance / values.size());
+        this->estimates.push_back(estimate);
+
+        if(estimate.halfwidth > this->precision * std::fabs(estimate.value))
+            reached = false;
+    }
+
+    return reached;
+}
+
+
+
+void StoppingRule::WriteReport(std::ostream &stream) const
+{
+    if(this->reached)
+        stream << "\e[1;34mPrecision of " << this->precision * 100.0 << "% reached after "
+               << this->samples.size() << " iterations\e[0m\n";
+    else
+        stream << "\e[1;33mWARNING:\e[0m Precision of " << this->precision * 100.0 << "% not reached after "
+               << this->samples.size() << " iterations\n";
+
+    if(this->estimates.empty())
+    {
+        stream << "\e[1;30m    (Too few iterations after the warm-up to estimate the precision)\e[0m\n";
+        return;
+    }
+
+    stream << "\e[1;30m    Warm-up: " << this->truncation << " iterations (MSER-5), "
+           << StoppingRule::BATCHES << " batches of " << this->batchsize << " iterations\e[0m\n";
+    for(const Estimate &estimate : this->estimates)
+    {
+        double relative = estimate.value != 0.0 ? estimate.halfwidth / std::fabs(estimate.value) : 0.0;
+        stream << "\e[1;36m    " << std::left << std::setw(8) << estimate.name + ":" << std::right
+               << "\e[1;37m" << estimate.value << " ± " << estimate.halfwidth << "ns"
+               << "\e[1;30m (" << relative * 100.0 << "%, " << this->confidence * 100.0 << "% confidence)\e[0m\n";
+    }
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
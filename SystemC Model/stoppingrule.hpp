@@ -0,0 +1,78 @@
+#ifndef STOPPINGRULE_HPP
+#define STOPPINGRULE_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Decides when enough iterations were simulated to estimate the mean (or quantiles)
+// of the iteration durations with the requested precision.
+//
+// Precision is the relative half-width of the confidence interval (0.01: ±1% of the estimate).
+//
+// The iteration durations are autocorrelated and the first ones are biased by the empty pipeline.
+// So at each check:
+//  1. The warm-up gets truncated with MSER-5 (White, 1997): The durations get averaged in groups of 5,
+//     and the truncation point minimizes the standard error of the remaining averages.
+//     If the best truncation point lies in the second half of the run, the run is still too short.
+//  2. The remaining durations get split into BATCHES batches of equal size (batch means method).
+//     The batch means (or batch quantiles) are nearly independent, so a Student t interval over them
+//     gives the confidence interval of the estimate.
+//
+// Checks happen after MINIMUMSAMPLES durations and then each time the number of durations grew by 10%,
+// so the cost of all checks is linear in the number of durations.
+// All durations are kept in memory (8 bytes per iteration).
+
+class StoppingRule
+{
+    public:
+        // quantiles: Probabilities of the quantiles that need the precision. Empty: The mean needs the precision.
+        StoppingRule(double precision, const std::vector<double> &quantiles = {}, double confidence = 0.95);
+
+        // Returns true as soon as all estimates reached the precision
+        bool Add(uint64_t sample);
+
+        // Estimates from all durations, also if the precision was not reached.
+        void Finish();
+        bool IsReached() const;
+        void WriteReport(std::ostream &stream) const;
+
+        // All durations and the schedule of the checks, for checkpoints
+        void SaveState(std::ostream &state) const;
+        void LoadState(std::istream &state);
+
+        static const size_t BATCHES        = 20;
+        static const size_t MSERBATCHSIZE  = 5;
+        static const size_t MINIMUMSAMPLES = 1000;
+
+    private:
+        struct Estimate
+        {
+            std::string name;
+            double      value;
+            double      halfwidth;
+        };
+
+        bool   Check();
+        size_t Truncation() const;  // MSER-5, in samples. SIZE_MAX if the warm-up is not over yet.
+        double BatchQuantile(size_t first, size_t size, double p);
+
+        double              precision;
+        std::vector<double> quantiles;
+        double              confidence;
+
+        std::vector<double> samples;
+        std::vector<double> scratch;
+        uint64_t            nextcheck;
+        bool                reached;
+
+        // Result of the last check
+        size_t                truncation;
+        size_t                batchsize;
+        std::vector<Estimate> estimates;
+};
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,93 @@
+#ifndef TIMINGFILE_HPP
+#define TIMINGFILE_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Binary timing files
+//
+// A binary timing file <name>.bin is the preprocessed version of the measured delays in <name>.txt.
+// It gets created by Tools/timing2bin and gets mapped into memory read-only by the DelayVector.
+// So all simulations on a host share the same physical copy of the delays.
+// All values are stored in the byte order of the host.
+//
+//   offset  size     content
+//    0      8        magic "SMCTIMES"
+//    8      4        version (1)
+//   12      4        element width: 4 (uint32_t) or 8 (double)
+//   16      8        number of delays n
+//   24      8        minimum (double)
+//   32      8        maximum (double)
+//   40      8        mean (double)
+//   48      8        standard deviation (double, n-1 normalized)
+//   56      4        flags (TIMINGFILE_SHUFFLED: The delays are shuffled by ShuffleDelays)
+//   60      4        reserved (0)
+//   64      n*width  delays
+
+struct TimingFileHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t width;
+    uint64_t count;
+    double   minimum;
+    double   maximum;
+    double   mean;
+    double   standarddeviation;
+    uint32_t flags;
+    uint32_t reserved;
+};
+static_assert(sizeof(TimingFileHeader) == 64, "Unexpected padding in TimingFileHeader");
+
+const char     TIMINGFILE_MAGIC[8]  = {'S', 'M', 'C', 'T', 'I', 'M', 'E', 'S'};
+const uint32_t TIMINGFILE_VERSION   = 1;
+const uint32_t TIMINGFILE_SHUFFLED  = 1 << 0;
+
+// Seed of the shuffle of the measured delays.
+// The simulator and the converter must use the same seed.
+const uint64_t TIMING_SHUFFLE_SEED = 0;
+
+
+
+// Fisher-Yates shuffle with a fixed random number generator.
+// Unlike std::random_shuffle, the permutation does not depend on the standard library
+// and is the same for every element type.
+template<typename T>
+void ShuffleDelays(std::vector<T> &delays, uint64_t seed = TIMING_SHUFFLE_SEED)
+{
+    std::mt19937_64 rng(seed);
+    for(size_t i = delays.size(); i > 1; i--)
+    {
+        size_t j = rng() % i;
+        std::swap(delays[i - 1], delays[j]);
+    }
+}
+
+
+
+// Mean and standard deviation, computed like gsl_stats_mean and gsl_stats_sd do,
+// so that binary and text timing files lead to identical results.
+template<typename T>
+std::pair<double, double> DelayMeanAndStandardDeviation(const T *delays, size_t n)
+{
+    double mean = 0.0;
+    for(size_t i = 0; i < n; i++)
+        mean += (delays[i] - mean) / (i + 1);
+
+    double variance = 0.0;
+    for(size_t i = 0; i < n; i++)
+    {
+        const double delta = delays[i] - mean;
+        variance += (delta * delta - variance) / (i + 1);
+    }
+
+    double sd = (n > 1) ? std::sqrt(variance * (static_cast<double>(n) / (n - 1))) : 0.0;
+    return std::make_pair(mean, sd);
+}
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,5 @@
+#!/usr/bin/env bash
+
+clang++ -std=c++14 -O2 -I"../../SystemC Model" -o timing2bin main.cpp
+
+# vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
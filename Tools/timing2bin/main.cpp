@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <timingfile.hpp>
+
+// Converts a text timing file (one delay per line) into a binary timing file.
+// See timingfile.hpp in the SystemC Model directory for the format.
+
+void PrintUsage()
+{
+    std::cerr << "timing2bin INPUT.txt [OUTPUT.bin]\n";
+    std::cerr << "  Without OUTPUT, the binary file gets stored next to INPUT with .bin as extension.\n";
+}
+
+
+
+template<typename T>
+bool WriteTimingFile(const std::string &path, std::vector<T> &delays, double minimum, double maximum)
+{
+    // Same processing as in the simulator: First shuffle, then analyze
+    ShuffleDelays(delays);
+    auto properties = DelayMeanAndStandardDeviation(delays.data(), delays.size());
+
+    TimingFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TIMINGFILE_MAGIC, sizeof(header.magic));
+    header.version           = TIMINGFILE_VERSION;
+    header.width             = sizeof(T);
+    header.count             = delays.size();
+    header.minimum           = minimum;
+    header.maximum           = maximum;
+    header.mean              = properties.first;
+    header.standarddeviation = properties.second;
+    header.flags             = TIMINGFILE_SHUFFLED;
+
+    // Write into a temporary file first, so that running simulations never map a partial file
+    std::string temporarypath = path + ".tmp";
+    std::ofstream file(temporarypath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(delays.data()), delays.size() * sizeof(T));
+    file.close();
+    if(file.fail())
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Writing " << temporarypath << " failed!\n";
+        std::remove(temporarypath.c_str());
+        return false;
+    }
+
+    if(std::rename(temporarypath.c_str(), path.c_str()) != 0)
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Renaming " << temporarypath << " to " << path << " failed!\n";
+        std::remove(temporarypath.c_str());
+        return false;
+    }
+
+    std::cerr << "\e[1;32m" << path << "\e[0m: " << header.count << " delays, "
+              << header.width << " bytes each, "
+              << "min = " << header.minimum << ", max = " << header.maximum
+              << ", mean = " << header.mean << ", sd = " << header.standarddeviation << "\n";
+    return true;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2 or argc > 3)
+    {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    std::string inputpath = argv[1];
+    std::string outputpath;
+    if(argc == 3)
+        outputpath = argv[2];
+    else
+    {
+        outputpath = inputpath;
+        if(outputpath.size() >= 4 and outputpath.compare(outputpath.size() - 4, 4, ".txt") == 0)
+            outputpath.erase(outputpath.size() - 4);
+        outputpath += ".bin";
+    }
+
+    std::ifstream input(inputpath);
+    if(not input.is_open())
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m Opening " << inputpath << " failed!\n";
+        return EXIT_FAILURE;
+    }
+
+    // Parse the delays like the simulator does
+    std::vector<double> delays;
+    for(std::string line; std::getline(input, line); )
+    {
+        try
+        {
+            delays.push_back(std::stod(line));
+        }
+        catch(std::exception &e)
+        {
+            std::cerr << "Parsing line \"" << line << "\" failed. This line will be ignored!\n";
+        }
+    }
+
+    if(delays.empty())
+    {
+        std::cerr << "\e[1;31mERROR:\e[0m " << inputpath << " contains no delays!\n";
+        return EXIT_FAILURE;
+    }
+
+    auto   extremes = std::minmax_element(delays.begin(), delays.end());
+    double minimum  = *extremes.first;
+    double maximum  = *extremes.second;
+
+    // Integer delays that fit into 32 bit get stored with half the size
+    bool integral = std::all_of(delays.begin(), delays.end(),
+            [](double delay) { return delay >= 0.0 and delay <= UINT32_MAX and std::floor(delay) == delay; });
+
+    bool success;
+    if(integral)
+    {
+        std::vector<uint32_t> integerdelays(delays.begin(), delays.end());
+        success = WriteTimingFile(outputpath, integerdelays, minimum, maximum);
+    }
+    else
+        success = WriteTimingFile(outputpath, delays, minimum, maximum);
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
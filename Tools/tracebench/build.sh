@@ -0,0 +1,36 @@
+#!/usr/bin/env bash
+
+# The benchmark uses the Monitor of the model, so it needs the same libraries
+MODEL="../../SystemC Model"
+
+SystemCDirectories=(
+"/opt/systemc"
+"/opt/systemc-2.3.3"
+"/usr/local/systemc-2.3.3"
+)
+
+for directory in "${SystemCDirectories[@]}" ;
+do
+    if [[ -d "$directory" ]] ; then
+        SYSTEMC="$directory"
+        break
+    fi
+done
+if [[ -z "$SYSTEMC" ]] ; then
+    echo -e "\e[1;31mSystemC not found!\e[0m"
+    exit 1
+fi
+
+SOURCE="main.cpp legacy.cpp"
+SOURCE+=" \"$MODEL/monitor.cpp\" \"$MODEL/statistics.cpp\" \"$MODEL/stoppingrule.cpp\" \"$MODEL/samplesink.cpp\""
+HEADER="-I. -I\"$MODEL\" -I$SYSTEMC/include $(pkg-config --cflags gsl)"
+LIBS="-L$SYSTEMC/lib-linux64 -lsystemc $(pkg-config --libs gsl) -lpthread"
+
+eval clang++ -std=c++14 -O2 $HEADER -o tracebench $SOURCE $LIBS
+
+# With libevd (EVDFLAGS: its compiler and linker flags), the trace points keep their runtime guard
+if [[ -n "$EVDFLAGS" ]] ; then
+    eval clang++ -std=c++14 -O2 -DENABLE_EVD $HEADER -o tracebench-evd $SOURCE $LIBS $EVDFLAGS
+fi
+
+# vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
@@ -0,0 +1,11 @@
+#include <legacy.hpp>
+
+void LegacyMonitor::ExpandTrace(std::string signalname, std::string value)
+{
+    if(this->enabletraceoutput)
+    {
+        // Writing the event is not part of the benchmark
+    }
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
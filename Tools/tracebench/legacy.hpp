@@ -0,0 +1,22 @@
+#ifndef LEGACY_HPP
+#define LEGACY_HPP
+
+#include <string>
+
+// The trace interface of the Monitor before signal IDs were introduced.
+// It is compiled in its own translation unit, like monitor.cpp in the model,
+// so that the compiler cannot inline the call.
+class LegacyMonitor
+{
+    public:
+        LegacyMonitor(bool enabletraceoutput)
+            : enabletraceoutput(enabletraceoutput) {};
+
+        void ExpandTrace(std::string signalname, std::string value);
+
+    private:
+        bool enabletraceoutput;
+};
+
+#endif
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4
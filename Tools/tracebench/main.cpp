@@ -0,0 +1,106 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <legacy.hpp>
+#include <monitor.hpp>
+
+// Measures the cost of the trace points of a simulated memory word access
+// (one "R" and one "IDLE" event) while trace output is disabled.
+//
+//  legacy:  Monitor::ExpandTrace(std::string, std::string) as it was before
+//  monitor: Monitor::ExpandTrace(TraceSignal, TRACEPHASE) of the model.
+//           Built with ENABLE_EVD (tracebench-evd), it costs the runtime guard.
+//           Without, it compiles to nothing.
+
+
+
+template<typename F>
+double Measure(const char *label, unsigned long words, unsigned long *memory, F access)
+{
+    auto start = std::chrono::steady_clock::now();
+    unsigned long sum = 0;
+    for(unsigned long i = 0; i < words; i++)
+        sum += access(memory, i & 0x7FFF);
+    auto stop  = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count() / words;
+    std::cout << label << ns << " ns/word" << "\e[1;30m (checksum " << sum << ")\e[0m\n";
+    return ns;
+}
+
+
+
+// The SystemC library defines main
+int sc_main(int argc, char *argv[])
+{
+    unsigned long words = 100000000;
+    if(argc > 1)
+        words = std::strtoul(argv[1], nullptr, 10);
+
+    // The runtime flag must not be known at compile time
+    bool enabletraceoutput = (argc > 2 and std::strcmp(argv[2], "--enable") == 0);
+
+    Monitor monitor;
+    if(enabletraceoutput)
+        monitor.EnableTraceOutput("tracebench.evd");
+    TraceSignal signal = monitor.RegisterSignal("SharedMemory");
+
+    std::vector<unsigned long> memory(32*1024, 1);
+
+    std::string   shortname = "SharedMemory";
+    std::string   longname  = "MB0.PrivateMemory.Instance";
+    LegacyMonitor legacymonitor(enabletraceoutput);
+
+    std::cout << "Per word trace overhead with trace output "
+              << (monitor.IsTraceEnabled() ? "enabled" : "disabled")
+              << ", " << words << " words\n";
+
+    auto plain = [&](unsigned long *m, unsigned long i)
+        {
+            return m[i];
+        };
+    Measure("warm-up:               ", words, memory.data(), plain);
+    double baseline = Measure("no trace points:       ", words, memory.data(), plain);
+    double legacyshort = Measure("legacy (short name):   ", words, memory.data(),
+        [&](unsigned long *m, unsigned long i)
+        {
+            legacymonitor.ExpandTrace(shortname, "R");
+            unsigned long word = m[i];
+            legacymonitor.ExpandTrace(shortname, "IDLE");
+            return word;
+        });
+    double legacylong = Measure("legacy (long name):    ", words, memory.data(),
+        [&](unsigned long *m, unsigned long i)
+        {
+            legacymonitor.ExpandTrace(longname, "R");
+            unsigned long word = m[i];
+            legacymonitor.ExpandTrace(longname, "IDLE");
+            return word;
+        });
+#ifdef ENABLE_EVD
+    const char *monitorlabel = "signal ID + guard:     ";
+#else
+    const char *monitorlabel = "compiled out:          ";
+#endif
+    double current = Measure(monitorlabel, words, memory.data(),
+        [&](unsigned long *m, unsigned long i)
+        {
+            monitor.ExpandTrace(signal, TRACEPHASE::MEMORY_READ);
+            unsigned long word = m[i];
+            monitor.ExpandTrace(signal, TRACEPHASE::MEMORY_IDLE);
+            return word;
+        });
+
+    std::cout << "\nOverhead relative to no trace points:\n"
+              << "legacy (short name):   " << legacyshort - baseline << " ns/word\n"
+              << "legacy (long name):    " << legacylong  - baseline << " ns/word\n"
+              << monitorlabel                << current     - baseline << " ns/word\n";
+
+    return 0;
+}
+
+// vim: tabstop=4 expandtab shiftwidth=4 softtabstop=4